@@ -66,10 +66,31 @@
 //	Global Definitions
 //*************************************************************************************************
 
-// Timer1 Settings (1s Interval)
+// Timer1 Settings (62.5ms Interval)
 #define TIMER1_PRESCALER								5			// :1024 --> 15.625kHz
-#define TIMER1_INITIAL_VALUE_COMPARE_MATCH_A			15624		// interrupt every 1 second
-#define TIMER1_CONVERSION_COMPARE						10			// time between conversions in seconds
+#define TIMER1_INITIAL_VALUE_COMPARE_MATCH_A			976			// interrupt every 62.5 ms
+#define TIMER1_TICKS_PER_SECOND							16
+
+// ticks to wait for a conversion (the first tick can come right after the start)
+#define TIMER1_CONVERSION_TICKS(res)					((((uint16_t)94 << (res)) * TIMER1_TICKS_PER_SECOND) / 1000 + 2)
+
+// polling states
+#define POLL_IDLE										0
+#define POLL_START										1
+#define POLL_CONVERT									2
+
+// bus work of a polling step, run on the DS2482 queue
+#define POLL_JOB_NONE									0
+#define POLL_JOB_POWER									1
+#define POLL_JOB_START									2
+#define POLL_JOB_CHECK									3
+#define POLL_JOB_READ									4
+#define POLL_JOB_RESOLUTION								5
+
+// a scratchpad read is the longest job (channel, match rom, command and 9 bytes)
+#if DS2482_QUEUE_SIZE < 21
+#error "DS2482_QUEUE_SIZE is too small for a queued scratchpad read"
+#endif
 
 
 //*************************************************************************************************
@@ -98,6 +119,9 @@
 #define TIMER1_WAVEFORM_GENERATION_MODE_L				WGM10
 #define TIMER1_WAVEFORM_GENERATION_MODE_H				WGM12
 
+// the store is sized with DS18B20_RECORD_SIZE before a record is declared (fails if they differ)
+typedef char StoreRecordSize[(sizeof(STORE_RECORD) == DS18B20_RECORD_SIZE) ? 1 : -1];
+
 
 //*************************************************************************************************
 //	Interrupts
@@ -106,76 +130,1420 @@
 #ifdef DS18B20_ISR_POLLING
 ISR(TIMER1_COMPARE_MATCH_A_VECTOR)
 {
-	static uint8_t isrCount = TIMER1_CONVERSION_COMPARE;
-	static uint8_t current = 0;
+	dsTemp.isr_ticks++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Run the next step of polling (call from the main loop, never waits on the onewire line)
+//		the bus work of a step is queued on the DS2482 and each call advances it by one op
+//		(ds2482.error_flags holds the bus errors of this step when it returns)
+//
+//	Input	none
+//
+//	Output	0 nothing to do until the next timer tick
+//			1 more work waiting (or queued bus work in flight)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::update(void)
+{
+	uint8_t channel, num, waiting;
+	
+	ds2482.error_flags = 0;
 	
-	if (isrCount < TIMER1_CONVERSION_COMPARE)
+	pollClock();
+	
+	if (_pollJob != POLL_JOB_NONE)
 	{
-		isrCount++;
+		if (!ds2482.queuePoll())
+		{
+			finishJob();
+		}
+		
+		return 1;
 	}
-	else
+	
+	switch (_pollState)
 	{
-		uint8_t totalSense;
-		
-		totalSense = dsTemp.totalSensors();
-		
-		if (current <= totalSense)
-		{
-			Device sensor;
-			Scratch scratch;
+		case POLL_IDLE:
+			_pollConverting = scheduleSensors();
+			
+			if (!_pollConverting)
+			{
+				return 0;
+			}
+			
+			_pollStart = _pollConverting;
+			_pollState = POLL_START;
+			return 1;
+			
+		case POLL_START:
+			if (_pollStart == 0)
+			{
+				_pollRound = _pollClock;
+				_pollChecked = _pollClock;
+				_pollReady = 0;
+				_pollCheck = 0;
+				_pollState = POLL_CONVERT;
+				return 1;
+			}
+			
+			// the strong pullup only holds the selected channel, so a parasite channel goes last
+			waiting = _pollStart & _pollPowered;
+			waiting = (waiting) ? waiting : _pollStart;
+			
+			for (channel = 0; !(waiting & (1 << channel)); channel++);
+			
+			_pollStart &= ~(1 << channel);
+			startChannel(channel);
+			return 1;
+			
+		case POLL_CONVERT:
+			// channels are read as soon as they are done
+			num = nextSensor();
+			
+			if (num)
+			{
+				readSensor(num);
+				return 1;
+			}
+			
+			waiting = _pollConverting & ~_pollReady;
+			
+			if (!waiting)
+			{
+				_pollState = POLL_IDLE;
+				
+				publishTemps();
+				return 1;
+			}
+			
+			// check the channels once per tick
+			if (_pollCheck == 0)
+			{
+				if (_pollClock == _pollChecked)
+				{
+					return 0;
+				}
+				
+				_pollChecked = _pollClock;
+				
+				// a parasite channel keeps the strong pullup only while the bus is quiet
+				if (waiting & ~_pollPowered)
+				{
+					waiting &= ~_pollPowered;
+				}
+				
+				_pollCheck = waiting;
+			}
+			
+			// channels past their conversion time are done, a powered one is asked (one per call)
+			for (channel = 0; channel < DS2482_TOTAL_CHANNELS; channel++)
+			{
+				if (!(_pollCheck & (1 << channel)))
+				{
+					continue;
+				}
+				
+				_pollCheck &= ~(1 << channel);
+				
+				if (conversionReady(channel))
+				{
+					_pollReady |= (1 << channel);
+				}
+				else if (_pollPowered & (1 << channel))
+				{
+					checkChannel(channel);
+					return 1;
+				}
+			}
+			
+			return (_pollReady & waiting) ? 1 : 0;
+	}
+	
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Run the queued bus work of a polling step
+//
+//	Input	job: what the queue does (the result is handled by finishJob)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::startJob(uint8_t job)
+{
+	_pollJob = job;
+	ds2482.queueStart(0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Handle the result of the queued bus work once the queue has finished
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::finishJob(void)
+{
+	uint8_t job, channel, num, powered;
+	
+	job = _pollJob;
+	_pollJob = POLL_JOB_NONE;
+	
+	channel = _pollJobChannel;
+	num = _pollJobNum;
+	
+	switch (job)
+	{
+		case POLL_JOB_POWER:
+			// nothing answers on the channel, its sensors are read (and fail) in turn
+			if (ds2482.error_flags)
+			{
+				ds2482.error_flags = 0;
+				_convertStart[channel] = _pollClock;
+				break;
+			}
+			
+			powered = ds2482.queue[_pollJobIndex].data;
+			
+			ds2482.queueClear();
+			ds2482.queueSkip();
+			
+			if (!powered)
+			{
+				ds2482.queueConfig(DS2482_CONFIG_SPU);
+			}
+			
+			ds2482.queueWrite(DS18B20_CONVERT_TEMP);
+			startJob(POLL_JOB_START);
+			break;
+			
+		case POLL_JOB_START:
+			ds2482.error_flags = 0;
+			_convertStart[channel] = _pollClock;
+			break;
 			
-			if (current > 0)
+		case POLL_JOB_CHECK:
+			// stop waiting on a faulty channel and leave the rest for the next tick
+			if (ds2482.error_flags)
+			{
+				_pollReady |= (1 << channel);
+				_pollCheck = 0;
+			}
+			else if (ds2482.queue[_pollJobIndex].data)
 			{
-				dsTemp.loadSensor(current, sensor);
-				dsTemp.readScratchpad(sensor, scratch);
-				dsTemp.temps[current] = scratch.temp[(dsTemp.isr_flags & (TEMP_F << ISR_FLAG_UNITS)) ? TEMP_F : TEMP_C];
+				_pollReady |= (1 << channel);
 			}
+			break;
 			
-			current++;
+		case POLL_JOB_READ:
+			sensorRead(num);
+			break;
 			
-			if (current <= totalSense)
+		case POLL_JOB_RESOLUTION:
+			if (ds2482.error_flags == 0)
 			{
-				dsTemp.loadSensor(current, sensor);
-				dsTemp.startConversion(sensor);
+				_sensorResolution[num] = _pollJobResolution;
 			}
+			break;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Move the 16 bit scheduler clock up to the 8 bit timer tick
+//		(a single byte read, safe against the ISR; needs a call at least every 16 seconds)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::pollClock(void)
+{
+	uint8_t ticks;
+	
+	ticks = isr_ticks;
+	_pollClock += (uint8_t)(ticks - _pollTick);
+	_pollTick = ticks;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Check if the conversion time for the resolution has passed on a channel (no bus work)
+//		(powered channels can finish sooner, see checkChannel)
+//
+//	Input	channel: one wire channel
+//
+//	Output	0 still converting
+//			1 done
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::conversionReady(uint8_t channel)
+{
+	pollClock();
+	
+	return ((uint16_t)(_pollClock - _convertStart[channel]) >= TIMER1_CONVERSION_TICKS(_convertResolution[channel])) ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a read time slot on a powered channel (the sensors hold it low until they are done)
+//		(a parasite channel is never asked, a read slot would end the strong pullup)
+//
+//	Input	channel: one wire channel
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::checkChannel(uint8_t channel)
+{
+	ds2482.queueClear();
+	
+	#ifdef DS2482_800
+	ds2482.queueChannel(channel);
+	#endif
+	
+	_pollJobIndex = ds2482.queueReadBit();
+	_pollJobChannel = channel;
+	
+	startJob(POLL_JOB_CHECK);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the sampling interval of a sensor in timer ticks
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	ticks
+//
+//-------------------------------------------------------------------------------------------------
+
+uint16_t DS18B20::intervalTicks(Device &sensor)
+{
+	uint8_t seconds = (sensor.interval) ? sensor.interval : DS18B20_DEFAULT_INTERVAL;
+	
+	return (uint16_t)seconds * TIMER1_TICKS_PER_SECOND;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Pick the channels to convert for the sensors that are due
+//		(every powered channel with a due sensor, and the parasite channel with the most urgent one)
+//
+//	Input	none
+//
+//	Output	channel bit mask (0 nothing due)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::scheduleSensors(void)
+{
+	Device sensor;
+	uint8_t num, parasite, channel;
+	int16_t urgency, parasiteUrgency;
+	
+	_pollPowered = 0;
+	parasite = 0;
+	parasiteUrgency = 0;
+	
+	for (channel = 0; channel < DS2482_TOTAL_CHANNELS; channel++)
+	{
+		_convertResolution[channel] = 0;
+	}
+	
+	for (num = 1; num <= eepromTotal && num < DS18B20_BUFFER_SIZE; num++)
+	{
+		loadSensor(num, sensor);
+		ds2482.error_flags = 0;
+		
+		if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+		{
+			continue;
 		}
-		else
+		
+		// a deadline further out than one interval was set before the clock wrapped
+		if ((int16_t)(_pollDue[num] - _pollClock) > (int16_t)intervalTicks(sensor))
 		{
-			isrCount = 0;
-			current = 0;
-			
-			dsTemp.isr_flags |= (1 << ISR_FLAG_NEW_TEMPS);
+			_pollDue[num] = _pollClock;
+		}
+		
+		urgency = (int16_t)(_pollClock - _pollDue[num]);
+		
+		if (urgency < 0)
+		{
+			continue;
+		}
+		
+		urgency += sensor.config.priority * (DS18B20_PRIORITY_SECONDS * TIMER1_TICKS_PER_SECOND);
+		
+		// the slowest sensor to be read sets the conversion time of its channel
+		if (_convertResolution[sensor.config.channel] < _sensorResolution[num])
+		{
+			_convertResolution[sensor.config.channel] = _sensorResolution[num];
+		}
+		
+		if (sensor.config.powered)
+		{
+			_pollPowered |= (1 << sensor.config.channel);
+		}
+		else if (!parasite || urgency > parasiteUrgency)
+		{
+			parasite = (1 << sensor.config.channel);
+			parasiteUrgency = urgency;
 		}
 	}
+	
+	// a parasite sensor shares its channel with powered ones that are not due
+	parasite &= ~_pollPowered;
+	
+	return _pollPowered | parasite;
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Set polling
+// Get the most urgent sensor converted this round and not read yet
+//		(earliest deadline, moved ahead by priority)
 //
-//	Input	set: polling state
+//	Input	none
+//
+//	Output	device number (0 none left on the channels that are done)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::nextSensor(void)
+{
+	Device sensor;
+	uint8_t num, next;
+	int16_t urgency, nextUrgency;
+	
+	next = 0;
+	nextUrgency = 0;
+	
+	for (num = 1; num <= eepromTotal && num < DS18B20_BUFFER_SIZE; num++)
+	{
+		loadSensor(num, sensor);
+		ds2482.error_flags = 0;
+		
+		if (sensor.addr[0] != DS18B20_FAMILY_CODE || !(_pollReady & (1 << sensor.config.channel)))
+		{
+			continue;
+		}
+		
+		// due when the conversion started (a read moves the deadline past it)
+		urgency = (int16_t)(_pollRound - _pollDue[num]);
+		
+		if (urgency < 0)
+		{
+			continue;
+		}
+		
+		urgency += sensor.config.priority * (DS18B20_PRIORITY_SECONDS * TIMER1_TICKS_PER_SECOND);
+		
+		if (!next || urgency > nextUrgency)
+		{
+			next = num;
+			nextUrgency = urgency;
+		}
+	}
+	
+	return next;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Check if a temperature is close to an alarm limit
+//
+//	Input	whole: temperature (whole degrees C)
+//			limit: alarm limit (whole degrees C)
+//
+//	Output	0 not close
+//			1 within DS18B20_ALARM_MARGIN
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::nearAlarm(int8_t whole, uint8_t limit)
+{
+	int16_t distance = whole - (int8_t)limit;
+	
+	return (distance >= -DS18B20_ALARM_MARGIN && distance <= DS18B20_ALARM_MARGIN) ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Pick the resolution for the next conversion of a sensor and queue it if it changed
+//		(stable sensors drop a step at a time, moving ones or ones near an alarm go to 12 bit)
+//
+//	Input	num: device number
+//			&sensor: reference to device data
+//			&scratch: reference to the scratchpad just read
+//			change: change from the last reading (1/16 degree)
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::polling(uint8_t set)
+void DS18B20::adaptResolution(uint8_t num, Device &sensor, Scratch &scratch, int16_t change)
 {
-	if (set)
+	uint8_t resolution, target, step;
+	int8_t whole;
+	
+	// what the sensor really has (it goes back to the stored config after a power loss)
+	resolution = (scratch.config CONFIG_RES_SHIFT) & 0x03;
+	_sensorResolution[num] = resolution;
+	
+	target = sensor.config.resolution;
+	
+	if (isr_flags & (1 << ISR_FLAG_ADAPTIVE))
 	{
-		// Start timer clock (CTC Mode)
-		TIMER1_CONTROL_REGISTER_B |= (TIMER1_PRESCALER << TIMER1_CLOCK_SELECT);
+		// one step of the current resolution, a change within it is noise
+		step = 8 >> resolution;
+		whole = scratch.temp[TEMP_C] >> 4;
+		
+		if (change < 0)
+		{
+			change = -change;
+		}
+		
+		if (change >= DS18B20_MOVING_CHANGE || change > 2 * step || nearAlarm(whole, scratch.alarmHigh) || nearAlarm(whole, scratch.alarmLow))
+		{
+			target = 3;
+		}
+		else if (change <= step && resolution > DS18B20_MIN_RESOLUTION)
+		{
+			target = resolution - 1;
+		}
+		else
+		{
+			target = resolution;
+		}
+	}
+	
+	if (target != resolution)
+	{
+		// scratchpad only, the sensor eeprom keeps the stored resolution
+		ds2482.queueClear();
+		
+		#ifdef DS2482_800
+		ds2482.queueChannel(sensor.config.channel);
+		#endif
+		
+		ds2482.queueMatch(sensor.addr);
+		ds2482.queueWrite(DS18B20_WRITE_SCRATCHPAD);
+		
+		ds2482.queueWrite(scratch.alarmHigh);
+		ds2482.queueWrite(scratch.alarmLow);
+		ds2482.queueWrite((target << 5) | 0x1F);
+		
+		_pollJobNum = num;
+		_pollJobResolution = target;
+		
+		startJob(POLL_JOB_RESOLUTION);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Copy the finished round to temps[] (the sequence is odd while the copy is made)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::publishTemps(void)
+{
+	uint8_t num;
+	
+	_tempsSequence++;
+	
+	for (num = 0; num < DS18B20_BUFFER_SIZE; num++)
+	{
+		temps[num] = _pollTemps[num];
+		_tempsTimes[num] = _pollTimes[num];
+	}
+	
+	for (num = 0; num < sizeof(_pollValid); num++)
+	{
+		_tempsValid[num] = _pollValid[num];
+	}
+	
+	_tempsSequence++;
+	
+	isr_flags |= (1 << ISR_FLAG_NEW_TEMPS);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get a consistent copy of the last round of temperatures
+//
+//	Input	&snap: reference to snapshot (copied only when its sequence is out of date)
+//
+//	Output	0 no new temperatures
+//			1 snapshot updated
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::snapshot(Snapshot &snap)
+{
+	uint8_t sequence, num;
+	
+	do
+	{
+		sequence = _tempsSequence;
+		
+		// a copy in progress is never waited on (the reader may have interrupted it)
+		if ((sequence & 0x01) || sequence == snap.sequence)
+		{
+			return 0;
+		}
+		
+		for (num = 0; num < DS18B20_BUFFER_SIZE; num++)
+		{
+			snap.temps[num] = temps[num];
+			snap.times[num] = _tempsTimes[num];
+		}
+		
+		for (num = 0; num < sizeof(snap.valid); num++)
+		{
+			snap.valid[num] = _tempsValid[num];
+		}
+	}
+	while (sequence != _tempsSequence);
+	
+	snap.sequence = sequence;
+	
+	return 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the age of a sensor's reading in a snapshot
+//		(the clock wraps after about 68 minutes, as the history does)
+//
+//	Input	&snap: reference to snapshot
+//			num: device number
+//
+//	Output	seconds since the reading was converted
+//
+//-------------------------------------------------------------------------------------------------
+
+uint16_t DS18B20::snapshotAge(Snapshot &snap, uint8_t num)
+{
+	return (uint16_t)(_pollClock - snap.times[num]) / TIMER1_TICKS_PER_SECOND;
+}
+
+#ifdef DS18B20_HISTORY
+//-------------------------------------------------------------------------------------------------
+//
+// Add a reading to a sensor's history and update its statistics
+//		(sum and min/max as samples come and go, slope is a least squares fit over the window)
+//
+//	Input	num: device number
+//			temp: reading (temps[] units)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::recordHistory(uint8_t num, int16_t temp)
+{
+	History &hist = _history[num];
+	uint8_t i, slot, rescan;
+	int16_t oldest, x, meanX, meanY;
+	int32_t sumX, fit, spread;
+	
+	rescan = 0;
+	
+	if (hist.count == DS18B20_HISTORY_DEPTH)
+	{
+		// the head is the oldest sample once the ring is full
+		oldest = hist.samples[hist.head].temp;
+		hist.sum -= oldest;
+		rescan = (oldest == hist.min || oldest == hist.max);
+	}
+	else
+	{
+		hist.count++;
+	}
+	
+	hist.samples[hist.head].temp = temp;
+	hist.samples[hist.head].time = _pollRound;
+	hist.head = (hist.head + 1) % DS18B20_HISTORY_DEPTH;
+	hist.sum += temp;
+	
+	if (hist.count == 1 || rescan)
+	{
+		hist.min = temp;
+		hist.max = temp;
+		
+		for (i = 0; i < hist.count; i++)
+		{
+			oldest = hist.samples[i].temp;
+			
+			if (oldest < hist.min)
+			{
+				hist.min = oldest;
+			}
+			
+			if (oldest > hist.max)
+			{
+				hist.max = oldest;
+			}
+		}
+	}
+	else if (temp < hist.min)
+	{
+		hist.min = temp;
+	}
+	else if (temp > hist.max)
+	{
+		hist.max = temp;
+	}
+	
+	hist.slope = 0;
+	
+	if (hist.count < 2)
+	{
+		return;
+	}
+	
+	// x is seconds before the newest sample (the window must stay under an hour)
+	sumX = 0;
+	
+	for (i = 0; i < hist.count; i++)
+	{
+		slot = (hist.head + DS18B20_HISTORY_DEPTH - 1 - i) % DS18B20_HISTORY_DEPTH;
+		sumX -= (uint16_t)(_pollRound - hist.samples[slot].time) / TIMER1_TICKS_PER_SECOND;
+	}
+	
+	meanX = sumX / hist.count;
+	meanY = hist.sum / hist.count;
+	fit = 0;
+	spread = 0;
+	
+	for (i = 0; i < hist.count; i++)
+	{
+		slot = (hist.head + DS18B20_HISTORY_DEPTH - 1 - i) % DS18B20_HISTORY_DEPTH;
+		x = -(int16_t)((uint16_t)(_pollRound - hist.samples[slot].time) / TIMER1_TICKS_PER_SECOND) - meanX;
+		
+		fit += (int32_t)x * (hist.samples[slot].temp - meanY);
+		spread += (int32_t)x * x;
+	}
+	
+	// scale down so the change per minute fits 32 bits
+	while (fit > 0x01FFFFFFL || fit < -0x01FFFFFFL)
+	{
+		fit /= 2;
+		spread /= 2;
+	}
+	
+	if (spread > 0)
+	{
+		fit = fit * 60 / spread;
+		hist.slope = (fit > 32767) ? 32767 : (fit < -32768) ? -32768 : fit;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Clear the history of every sensor
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::clearHistory(void)
+{
+	uint8_t num;
+	
+	for (num = 0; num < DS18B20_BUFFER_SIZE; num++)
+	{
+		_history[num].head = 0;
+		_history[num].count = 0;
+		_history[num].sum = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the statistics of a sensor's recent readings
+//
+//	Input	num: device number
+//			&stats: reference to trend data
+//
+//	Output	samples in the history (0 none, stats not changed)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::trend(uint8_t num, Trend &stats)
+{
+	History *hist;
+	uint8_t newest, oldest;
+	
+	if (num <= 0 || num >= DS18B20_BUFFER_SIZE || _history[num].count == 0)
+	{
+		return 0;
+	}
+	
+	hist = &_history[num];
+	
+	newest = (hist->head + DS18B20_HISTORY_DEPTH - 1) % DS18B20_HISTORY_DEPTH;
+	oldest = (hist->head + DS18B20_HISTORY_DEPTH - hist->count) % DS18B20_HISTORY_DEPTH;
+	
+	stats.count = hist->count;
+	stats.latest = hist->samples[newest].temp;
+	stats.min = hist->min;
+	stats.max = hist->max;
+	stats.mean = hist->sum / hist->count;
+	stats.slope = hist->slope;
+	stats.span = (uint16_t)(hist->samples[newest].time - hist->samples[oldest].time) / TIMER1_TICKS_PER_SECOND;
+	stats.age = (uint16_t)(_pollClock - hist->samples[newest].time) / TIMER1_TICKS_PER_SECOND;
+	
+	return stats.count;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get a reading from a sensor's history
+//
+//	Input	num: device number
+//			back: 0 newest, 1 the one before...
+//			&temp: reference to the reading (temps[] units)
+//			&age: reference to the seconds since it was taken
+//
+//	Output	0 no such reading
+//			1 reading found
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::history(uint8_t num, uint8_t back, int16_t &temp, uint16_t &age)
+{
+	uint8_t slot;
+	
+	if (num <= 0 || num >= DS18B20_BUFFER_SIZE || back >= _history[num].count)
+	{
+		return 0;
+	}
+	
+	slot = (_history[num].head + DS18B20_HISTORY_DEPTH - 1 - back) % DS18B20_HISTORY_DEPTH;
+	
+	temp = _history[num].samples[slot].temp;
+	age = (uint16_t)(_pollClock - _history[num].samples[slot].time) / TIMER1_TICKS_PER_SECOND;
+	
+	return 1;
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the channels that have stored sensors
+//
+//	Input	parasite: only channels with a parasite powered sensor
+//
+//	Output	channel bit mask
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::sensorChannels(uint8_t parasite)
+{
+	uint8_t mask, num;
+	
+	mask = 0;
+	
+	for (num = 1; num <= eepromTotal; num++)
+	{
+		Device sensor;
+		
+		loadSensor(num, sensor);
+		
+		if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+		{
+			continue;
+		}
+		
+		if (!parasite || !sensor.config.powered)
+		{
+			mask |= (1 << sensor.config.channel);
+		}
+	}
+	
+	return mask;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a skip rom conversion on a channel, after asking it for the power mode
+//		(the conversion itself is queued by finishJob, with the strong pullup if needed)
+//
+//	Input	channel: one wire channel (a parasite channel has to be started last, on its own)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::startChannel(uint8_t channel)
+{
+	ds2482.queueClear();
+	
+	#ifdef DS2482_800
+	ds2482.queueChannel(channel);
+	#endif
+	
+	ds2482.queueSkip();
+	ds2482.queueWrite(DS18B20_READ_POWER_MODE);
+	
+	_pollJobIndex = ds2482.queueReadBit();
+	_pollJobChannel = channel;
+	
+	startJob(POLL_JOB_POWER);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a scratchpad read of a stored sensor
+//
+//	Input	num: device number
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::readSensor(uint8_t num)
+{
+	Device sensor;
+	uint8_t i;
+	
+	loadSensor(num, sensor);
+	
+	ds2482.queueClear();
+	
+	#ifdef DS2482_800
+	ds2482.queueChannel(sensor.config.channel);
+	#endif
+	
+	if (soleSensor(sensor))
+	{
+		ds2482.queueSkip();
+	}
+	else
+	{
+		ds2482.queueMatch(sensor.addr);
+	}
+	
+	ds2482.queueWrite(DS18B20_READ_SCRATCHPAD);
+	
+	_pollJobIndex = ds2482.queueRead();
+	
+	for (i = 1; i < 9; i++)
+	{
+		ds2482.queueRead();
+	}
+	
+	_pollJobNum = num;
+	
+	startJob(POLL_JOB_READ);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Take the temperature from a queued scratchpad read
+//
+//	Input	num: device number
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::sensorRead(uint8_t num)
+{
+	Device sensor;
+	Scratch scratch;
+	uint8_t scratch_buf[9];
+	uint8_t i, error;
+	
+	if (ds2482.error_flags == 0)
+	{
+		for (i = 0; i < 9; i++)
+		{
+			scratch_buf[i] = ds2482.queue[_pollJobIndex + i].data;
+		}
+		
+		decodeScratchpad(scratch_buf, scratch);
+	}
+	
+	error = ds2482.error_flags;
+	
+	loadSensor(num, sensor);
+	ds2482.error_flags = error;
+	
+	#ifdef DS18B20_SENSOR_CACHE
+	// another device may answer skip rom now
+	if (error & (1 << ERROR_CRC_MISMATCH))
+	{
+		_soleSensor[sensor.config.channel] = 0;
+	}
+	#endif
+	
+	if (error == 0)
+	{
+		int16_t temp = scratch.temp[(isr_flags & (TEMP_F << ISR_FLAG_UNITS)) ? TEMP_F : TEMP_C];
+			
+		// the change is judged in C whatever units temps[] are in
+		adaptResolution(num, sensor, scratch, scratch.temp[TEMP_C] - _sensorCelsius[num]);
+		_sensorCelsius[num] = scratch.temp[TEMP_C];
+		
+		#ifdef DS18B20_HISTORY
+		recordHistory(num, temp);
+		#endif
+		
+		_pollTemps[num] = temp;
+		_pollTimes[num] = _pollRound;
+		_pollValid[num >> 3] |= (1 << (num & 0x07));
+	}
+	else
+	{
+		_pollValid[num >> 3] &= ~(1 << (num & 0x07));
+	}
+	
+	// next sample one interval after this conversion, read or not
+	_pollDue[num] = _pollRound + intervalTicks(sensor);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Set polling
+//
+//	Input	set: polling state
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::polling(uint8_t set)
+{
+	if (set)
+	{
+		// Start timer clock (CTC Mode)
+		TIMER1_CONTROL_REGISTER_B |= (TIMER1_PRESCALER << TIMER1_CLOCK_SELECT);
+	}
+	else
+	{
+		// Stop timer clock (CTC Mode)
+		TIMER1_CONTROL_REGISTER_B &= ~(TIMER1_PRESCALER << TIMER1_CLOCK_SELECT);
+	}
+}
+#endif
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+//*************************************************************************************************
+//	Onewire temperature sensor functions
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the power mode of all devices on channel
+//
+//	Input	none
+//
+//	Output	power mode
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::powerMode(void)
+{
+	ds2482.romSkip();
+	ds2482.wireWrite(DS18B20_READ_POWER_MODE);
+	
+	return ds2482.wireReadBit();
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the power mode of a device
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	power mode
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::powerMode(Device &sensor)
+{
+	ds2482.romMatch(sensor.addr);
+	ds2482.wireWrite(DS18B20_READ_POWER_MODE);
+	
+	return ds2482.wireReadBit();
+}
+
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Store scratchpad to device EEPROM
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::storeSensorEE(Device &sensor)
+{
+	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	{
+		return;
+	}
+	
+	ds2482.romMatch(sensor.addr);
+	
+	if (!sensor.config.powered)
+	{
+		ds2482.setConfig(DS2482_CONFIG_SPU);
+	}
+	
+	ds2482.wireWrite(DS18B20_COPY_SCRATCHPAD);
+	
+	if (sensor.config.powered)
+	{
+		while(!ds2482.wireReadBit())
+		{
+			_delay_us(20);
+		}
+	}
+	else
+	{
+		_delay_ms(10);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Load device EEPROM to scratchpad
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::loadSensorEE(Device &sensor)
+{
+	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	{
+		return;
+	}
+	
+	ds2482.romMatch(sensor.addr);
+	ds2482.wireWrite(DS18B20_RECALL_EEPROM);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Check if a search this session saw the sensor alone on its channel (so skip rom can address it)
+//		(a device added since corrupts the read crc, which goes back to match rom; never for writes)
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	0 match rom needed
+//			1 skip rom
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::soleSensor(Device &sensor)
+{
+	#ifdef DS18B20_SENSOR_CACHE
+	uint8_t num = _soleSensor[sensor.config.channel];
+	
+	if (num && memcmp(_cache[num - 1].addr, sensor.addr, 8) == 0)
+	{
+		return 1;
+	}
+	#endif
+	
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Address a sensor for a read or conversion (skip rom when a search saw it alone on its channel)
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::selectSensor(Device &sensor)
+{
+	if (soleSensor(sensor))
+	{
+		ds2482.romSkip();
+	}
+	else
+	{
+		ds2482.romMatch(sensor.addr);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Initiate temperature conversion for all devices on channel
+//
+//	Input	channel: channel to convert
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::startConversion(uint8_t channel)
+{
+	uint8_t powered;
+	
+	#ifdef DS2482_800
+	ds2482.setChannel(channel);
+	#endif
+	
+	powered = powerMode();
+	
+	if (ds2482.error_flags & (1 << ERROR_NO_DEVICE))
+	{
+		ds2482.error_flags &= ~(1 << ERROR_NO_DEVICE);
+		return;
+	}
+	
+	ds2482.romSkip();
+	
+	if (!powered)
+	{
+		ds2482.setConfig(DS2482_CONFIG_SPU);
+	}
+	
+	ds2482.wireWrite(DS18B20_CONVERT_TEMP);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Initiate temperature conversion for device
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::startConversion(Device &sensor)
+{
+	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	{
+		return;
+	}
+	
+	#ifdef DS2482_800
+	ds2482.setChannel(sensor.config.channel);
+	#endif
+	
+	selectSensor(sensor);
+	
+	if (!sensor.config.powered)
+	{
+		ds2482.setConfig(DS2482_CONFIG_SPU);
+	}
+	
+	ds2482.wireWrite(DS18B20_CONVERT_TEMP);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Wait for temperature conversion to complete
+//
+//	Input	powered: is device powered
+//			resolution: max resolution on channel
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::conversionDelay(uint8_t powered, uint8_t resolution)
+{
+	if (powered)
+	{
+		while(!ds2482.wireReadBit())
+		{
+			_delay_us(20);
+		}
+	}
+	else
+	{
+		_delay_ms(94 << resolution);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Write scratchpad to temperature device
+//
+//	Input	&sensor: reference to device data
+//			&scratch: reference to scratchpad
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::writeScratchpad(Device &sensor, Scratch &scratch)
+{
+	sendScratchpad(sensor, scratch);
+	storeSensorEE(sensor);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Write alarms and config to the scratchpad only (lost when the sensor loses power)
+//
+//	Input	&sensor: reference to device data
+//			&scratch: reference to scratchpad
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::sendScratchpad(Device &sensor, Scratch &scratch)
+{
+	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	{
+		return;
+	}
+	
+	#ifdef DS2482_800
+	ds2482.setChannel(sensor.config.channel);
+	#endif
+	
+	ds2482.romMatch(sensor.addr);
+	ds2482.wireWrite(DS18B20_WRITE_SCRATCHPAD);
+	
+	ds2482.wireWrite(scratch.alarmHigh);
+	ds2482.wireWrite(scratch.alarmLow);
+	ds2482.wireWrite(scratch.config);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Read temperature device scratchpad
+//
+//	Input	&sensor: reference to device data
+//			&scratch: reference to scratchpad
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::readScratchpad(Device &sensor, Scratch &scratch)
+{
+	uint8_t scratch_buf[9];
+	uint8_t i;
+	
+	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	{
+		return;
+	}
+	
+	#ifdef DS2482_800
+	ds2482.setChannel(sensor.config.channel);
+	#endif
+	
+	selectSensor(sensor);
+	ds2482.wireWrite(DS18B20_READ_SCRATCHPAD);
+	
+	for (i = 0; i < 9; i++)
+	{
+		scratch_buf[i] = ds2482.wireRead();
+	}
+	
+	decodeScratchpad(scratch_buf, scratch);
+	
+	#ifdef DS18B20_SENSOR_CACHE
+	// another device may answer skip rom now
+	if (ds2482.error_flags & (1 << ERROR_CRC_MISMATCH))
+	{
+		_soleSensor[sensor.config.channel] = 0;
+	}
+	#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Check and unpack the 9 bytes of a scratchpad
+//
+//	Input	*scratch_buf: pointer to the bytes read
+//			&scratch: reference to scratchpad
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::decodeScratchpad(uint8_t *scratch_buf, Scratch &scratch)
+{
+	uint8_t i, crc;
+	
+	crc = 0;
+	
+	for (i = 0; i < 9; i++)
+	{
+		crc = _crc_ibutton_update(crc, scratch_buf[i]);
 	}
-	else
+	
+	if (crc != 0)
 	{
-		// Stop timer clock (CTC Mode)
-		TIMER1_CONTROL_REGISTER_B &= ~(TIMER1_PRESCALER << TIMER1_CLOCK_SELECT);
+		ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
 	}
+	
+	scratch.temp[TEMP_C] = scratch_buf[DS18B20_SCRATCHPAD_TEMP_LSB];
+	scratch.temp[TEMP_C] |= ((int16_t)scratch_buf[DS18B20_SCRATCHPAD_TEMP_MSB]) << 8;
+	
+	scratch.temp[TEMP_F] = (scratch.temp[TEMP_C] * 9) / 5;
+	scratch.temp[TEMP_F] += (32 << 4);
+	
+	scratch.alarmHigh = scratch_buf[DS18B20_SCRATCHPAD_HIGH_ALARM];
+	scratch.alarmLow = scratch_buf[DS18B20_SCRATCHPAD_LOW_ALARM];
+	
+	scratch.config = scratch_buf[DS18B20_SCRATCHPAD_CONFIG_REG];
 }
-#endif
-
-
-
 
 
 
@@ -193,311 +1561,499 @@ void DS18B20::polling(uint8_t set)
 
 
 //*************************************************************************************************
-//	Onewire temperature sensor functions
+//	Eeprom sensor store functions
 //*************************************************************************************************
-
+//
+// Sensors are kept as a journal of records, each change appends a record with the next sequence
+// number and a crc and the sensor's older record is left behind. A torn write fails its crc so
+// the older record still stands. Records are written in turn around the store to spread the wear,
+// live records in the way are copied ahead of the new one (compaction).
+//
 //-------------------------------------------------------------------------------------------------
 //
-// Get the power mode of all devices on channel
+// Read a record from the store
 //
-//	Input	none
+//	Input	slot: record position in the store
+//			&record: reference to record data
 //
-//	Output	power mode
+//	Output	1 if the record is valid
 //
 //-------------------------------------------------------------------------------------------------
 
-uint8_t DS18B20::powerMode(void)
+uint8_t DS18B20::readRecord(uint8_t slot, StoreRecord &record)
 {
-	ds2482.romSkip();
-	ds2482.wireWrite(DS18B20_READ_POWER_MODE);
+	uint8_t *data, crc, i;
 	
-	return ds2482.wireReadBit();
+	eeprom_read_block((void*)&record, (const void*)(DS18B20_STORE_START + slot * sizeof(STORE_RECORD)), sizeof(STORE_RECORD));
+	
+	data = (uint8_t*)&record;
+	crc = 0;
+	
+	for (i = 0; i < sizeof(STORE_RECORD); i++)
+	{
+		crc = _crc_ibutton_update(crc, data[i]);
+	}
+	
+	// erased eeprom is never a sensor number
+	return (crc == 0 && record.num < DS18B20_BUFFER_SIZE);
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Get the power mode of a device
+// Write a record at the head of the store
 //
-//	Input	&sensor: reference to device data
+//	Input	num: device number (DS18B20_STORE_RESET clears the table)
+//			&sensor: reference to device data
 //
-//	Output	power mode
+//	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-uint8_t DS18B20::powerMode(Device &sensor)
+void DS18B20::writeRecord(uint8_t num, Device &sensor)
 {
-	ds2482.romMatch(sensor.addr);
-	ds2482.wireWrite(DS18B20_READ_POWER_MODE);
+	StoreRecord record;
+	uint8_t *data, crc, i;
 	
-	return ds2482.wireReadBit();
+	record.sequence = _storeSequence++;
+	record.num = num;
+	record.sensor = sensor;
+	
+	data = (uint8_t*)&record;
+	crc = 0;
+	
+	for (i = 0; i < sizeof(STORE_RECORD) - 1; i++)
+	{
+		crc = _crc_ibutton_update(crc, data[i]);
+	}
+	
+	record.crc = crc;
+	
+	eeprom_write_block((const void*)&record, (void*)(DS18B20_STORE_START + _storeHead * sizeof(STORE_RECORD)), sizeof(STORE_RECORD));
+	
+	if (num != DS18B20_STORE_RESET && num < DS18B20_BUFFER_SIZE)
+	{
+		_storeSlot[num] = _storeHead;
+	}
+	
+	_storeHead = (_storeHead + 1) % DS18B20_STORE_SLOTS;
 }
 
-
-
 //-------------------------------------------------------------------------------------------------
 //
-// Store scratchpad to device EEPROM
+// Check if a slot holds the latest record of a sensor
 //
-//	Input	&sensor: reference to device data
+//	Input	slot: record position in the store
 //
-//	Output	none
+//	Output	1 if live
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::storeSensorEE(Device &sensor)
+uint8_t DS18B20::storeLive(uint8_t slot)
 {
-	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
-	{
-		return;
-	}
+	uint8_t num;
 	
-	ds2482.romMatch(sensor.addr);
-	
-	if (!sensor.config.powered)
+	for (num = 1; num < DS18B20_BUFFER_SIZE; num++)
 	{
-		ds2482.setConfig(DS2482_CONFIG_SPU);
+		if (_storeSlot[num] == slot)
+		{
+			return 1;
+		}
 	}
 	
-	ds2482.wireWrite(DS18B20_COPY_SCRATCHPAD);
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Count the slots from the head that can be written without losing a sensor
+//
+//	Input	none
+//
+//	Output	free slots
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::storeFree(void)
+{
+	uint8_t free, slot;
 	
-	if (sensor.config.powered)
+	slot = _storeHead;
+	
+	for (free = 0; free < DS18B20_STORE_SLOTS; free++)
 	{
-		while(!ds2482.wireReadBit())
+		if (storeLive(slot))
 		{
-			_delay_us(20);
+			break;
 		}
+		
+		slot = (slot + 1) % DS18B20_STORE_SLOTS;
 	}
-	else
-	{
-		_delay_ms(10);
-	}
+	
+	return free;
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Load device EEPROM to scratchpad
+// Append a record to the store, copying live records ahead of the head first
 //
-//	Input	&sensor: reference to device data
+//	Input	num: device number (DS18B20_STORE_RESET clears the table)
+//			&sensor: reference to device data
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::loadSensorEE(Device &sensor)
+void DS18B20::appendRecord(uint8_t num, Device &sensor)
 {
-	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	StoreRecord record;
+	uint8_t slot, i;
+	
+	if (num == DS18B20_STORE_RESET)
 	{
-		return;
+		for (i = 0; i < DS18B20_BUFFER_SIZE; i++)
+		{
+			_storeSlot[i] = DS18B20_STORE_NONE;
+		}
 	}
 	
-	ds2482.romMatch(sensor.addr);
-	ds2482.wireWrite(DS18B20_RECALL_EEPROM);
+	// keep a free slot after the new record to copy the next live one into
+	while (storeFree() < 2)
+	{
+		slot = (_storeHead + storeFree()) % DS18B20_STORE_SLOTS;
+		
+		// the sensor whose latest record is in the way
+		for (i = 1; i < DS18B20_BUFFER_SIZE && _storeSlot[i] != slot; i++);
+		
+		if (readRecord(slot, record) && record.num == i)
+		{
+			writeRecord(record.num, record.sensor);
+		}
+		else
+		{
+			// a worn or torn record is not copied, the sensor is dropped from the store
+			_storeSlot[i] = DS18B20_STORE_NONE;
+			ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+		}
+	}
+	
+	writeRecord(num, sensor);
 }
 
-
 //-------------------------------------------------------------------------------------------------
 //
-// Initiate temperature conversion for all devices on channel
+// Replay the store to find the latest record of each sensor
+//		(a number below the highest with no record left is a gap, reported as a crc mismatch)
 //
-//	Input	channel: channel to convert
+//	Input	none
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::startConversion(uint8_t channel)
+void DS18B20::scanStore(void)
 {
-	uint8_t powered;
+	StoreRecord record;
+	uint8_t slot, newest, count, i;
 	
-	#ifdef DS2482_800
-	ds2482.setChannel(channel);
-	#endif
+	for (i = 0; i < DS18B20_BUFFER_SIZE; i++)
+	{
+		_storeSlot[i] = DS18B20_STORE_NONE;
+	}
 	
-	powered = powerMode();
+	newest = DS18B20_STORE_NONE;
+	_storeSequence = 0;
 	
-	if (ds2482.error_flags & (1 << ERROR_NO_DEVICE))
+	for (slot = 0; slot < DS18B20_STORE_SLOTS; slot++)
 	{
-		ds2482.error_flags &= ~(1 << ERROR_NO_DEVICE);
+		if (readRecord(slot, record) && (newest == DS18B20_STORE_NONE || (int16_t)(record.sequence - _storeSequence) > 0))
+		{
+			newest = slot;
+			_storeSequence = record.sequence;
+		}
+	}
+	
+	eepromTotal = 0;
+	
+	if (newest == DS18B20_STORE_NONE)
+	{
+		_storeHead = 0;
 		return;
 	}
 	
-	ds2482.romSkip();
+	_storeHead = (newest + 1) % DS18B20_STORE_SLOTS;
+	_storeSequence++;
 	
-	if (!powered)
+	// records were written in turn, so the oldest follows the newest
+	slot = _storeHead;
+	
+	for (count = 0; count < DS18B20_STORE_SLOTS; count++)
 	{
-		ds2482.setConfig(DS2482_CONFIG_SPU);
+		if (readRecord(slot, record))
+		{
+			if (record.num == DS18B20_STORE_RESET)
+			{
+				for (i = 0; i < DS18B20_BUFFER_SIZE; i++)
+				{
+					_storeSlot[i] = DS18B20_STORE_NONE;
+				}
+			}
+			else
+			{
+				_storeSlot[record.num] = slot;
+			}
+		}
+		
+		slot = (slot + 1) % DS18B20_STORE_SLOTS;
 	}
 	
-	ds2482.wireWrite(DS18B20_CONVERT_TEMP);
+	// the sensors past a dropped record keep their numbers
+	for (i = 1; i < DS18B20_BUFFER_SIZE; i++)
+	{
+		if (_storeSlot[i] != DS18B20_STORE_NONE)
+		{
+			eepromTotal = i;
+		}
+	}
+	
+	for (i = 1; i <= eepromTotal; i++)
+	{
+		if (_storeSlot[i] == DS18B20_STORE_NONE)
+		{
+			ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+		}
+	}
 }
 
 
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+//*************************************************************************************************
+//	Onewire temperature sensor management functions
+//*************************************************************************************************
+
 //-------------------------------------------------------------------------------------------------
 //
-// Initiate temperature conversion for device
+// Reset the number of sensors to zero (appends a reset record to the store)
 //
-//	Input	&sensor: reference to device data
+//	Input	none
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::startConversion(Device &sensor)
+void DS18B20::resetSensors(void)
 {
-	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	Device sensor;
+	
+	// an empty table is not written again
+	if (eepromTotal > 0)
 	{
-		return;
+		memset(&sensor, 0, sizeof(DEVICE));
+		appendRecord(DS18B20_STORE_RESET, sensor);
 	}
 	
-	#ifdef DS2482_800
-	ds2482.setChannel(sensor.config.channel);
-	#endif
-	
-	ds2482.romMatch(sensor.addr);
+	eepromTotal = 0;
 	
-	if (!sensor.config.powered)
-	{
-		ds2482.setConfig(DS2482_CONFIG_SPU);
-	}
+	#ifdef DS18B20_SENSOR_CACHE
+	hashSensors();
+	clearSole();
+	#endif
 	
-	ds2482.wireWrite(DS18B20_CONVERT_TEMP);
+	#if defined(DS18B20_ISR_POLLING) && defined(DS18B20_HISTORY)
+	clearHistory();
+	#endif
 }
 
+//-------------------------------------------------------------------------------------------------
+//
+// Get the total number of sensors stored
+//
+//	Input	none
+//
+//	Output	highest device number (a gap in the store loads as an empty sensor)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::totalSensors(void)
+{
+	return eepromTotal;
+}
 
 //-------------------------------------------------------------------------------------------------
 //
-// Wait for temperature conversion to complete
+// Read sensor data from the Eeprom store
 //
-//	Input	powered: is device powered
-//			resolution: max resolution on channel
+//	Input	num: device number
+//			&sensor: reference to device data
 //
-//	Output	none
+//	Output	rom crc (0 if valid)
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::conversionDelay(uint8_t powered, uint8_t resolution)
+uint8_t DS18B20::fetchSensor(uint8_t num, DEVICE &sensor)
 {
-	if (powered)
+	StoreRecord record;
+	uint8_t crc, i;
+	
+	// a gap in the store reads as an empty sensor (family 0, never polled)
+	if (_storeSlot[num] == DS18B20_STORE_NONE || !readRecord(_storeSlot[num], record))
 	{
-		while(!ds2482.wireReadBit())
-		{
-			_delay_us(20);
-		}
+		memset(&sensor, 0, sizeof(DEVICE));
+		return 0xFF;
 	}
-	else
+	
+	sensor = record.sensor;
+	
+	crc = 0;
+	
+	for (i = 0; i < 8; i++)
 	{
-		_delay_ms(94 << resolution);
+		crc = _crc_ibutton_update(crc, sensor.addr[i]);
 	}
+	
+	return crc;
 }
 
-
 //-------------------------------------------------------------------------------------------------
 //
-// Write scratchpad to temperature device
+// Load sensor data (from the ram cache when it holds the sensor)
 //
-//	Input	&sensor: reference to device data
-//			&scratch: reference to scratchpad
+//	Input	num: device number
+//			&sensor: reference to device data
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::writeScratchpad(Device &sensor, Scratch &scratch)
+void DS18B20::loadSensor(uint8_t num, DEVICE &sensor)
 {
-	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	if (num <= 0 || num > eepromTotal)
 	{
 		return;
 	}
 	
-	#ifdef DS2482_800
-	ds2482.setChannel(sensor.config.channel);
+	#ifdef DS18B20_SENSOR_CACHE
+	if (num <= DS18B20_CACHE_SIZE)
+	{
+		sensor = _cache[num - 1];
+		
+		// rom crc was checked when the cache was filled
+		if (_cacheBad[(num - 1) >> 3] & (1 << ((num - 1) & 0x07)))
+		{
+			ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+		}
+		return;
+	}
 	#endif
 	
-	ds2482.romMatch(sensor.addr);
-	ds2482.wireWrite(DS18B20_WRITE_SCRATCHPAD);
-	
-	ds2482.wireWrite(scratch.alarmHigh);
-	ds2482.wireWrite(scratch.alarmLow);
-	ds2482.wireWrite(scratch.config);
-	
-	storeSensorEE(sensor);
+	if (fetchSensor(num, sensor) != 0)
+	{
+		ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Read temperature device scratchpad
+// Store sensor data to Eeprom (appends a record to the store)
 //
-//	Input	&sensor: reference to device data
-//			&scratch: reference to scratchpad
+//	Input	num: device number
+//			&sensor: reference to device data
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::readScratchpad(Device &sensor, Scratch &scratch)
+void DS18B20::storeSensor(uint8_t num, DEVICE &sensor)
 {
-	uint8_t scratch_buf[9];
-	uint8_t i, crc;
+	Device stored;
 	
-	if (sensor.addr[0] != DS18B20_FAMILY_CODE)
+	if (num <= 0 || num > eepromTotal + 1)
 	{
 		return;
 	}
 	
-	#ifdef DS2482_800
-	ds2482.setChannel(sensor.config.channel);
-	#endif
-	
-	ds2482.romMatch(sensor.addr);
-	ds2482.wireWrite(DS18B20_READ_SCRATCHPAD);
-	
-	crc = 0;
-	
-	for (i = 0; i < 9; i++)
+	// past the sensor capacity
+	if (num > DS18B20_MAX_SENSORS)
 	{
-		scratch_buf[i] = ds2482.wireRead();
-		crc = _crc_ibutton_update(crc, scratch_buf[i]);
+		ds2482.error_flags |= (1 << ERROR_EEPROM_FULL);
+		return;
 	}
 	
-	if (crc != 0)
+	// unchanged sensors are not written again (unless dropped from the store)
+	if (num <= eepromTotal && _storeSlot[num] != DS18B20_STORE_NONE)
 	{
-		ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+		#ifdef DS18B20_SENSOR_CACHE
+		if (num <= DS18B20_CACHE_SIZE)
+		{
+			stored = _cache[num - 1];
+		}
+		else
+		#endif
+		{
+			fetchSensor(num, stored);
+		}
+		
+		if (memcmp(&stored, &sensor, sizeof(DEVICE)) == 0)
+		{
+			return;
+		}
 	}
 	
-	scratch.temp[TEMP_C] = scratch_buf[DS18B20_SCRATCHPAD_TEMP_LSB];
-	scratch.temp[TEMP_C] |= ((int16_t)scratch_buf[DS18B20_SCRATCHPAD_TEMP_MSB]) << 8;
+	#ifdef DS18B20_SENSOR_CACHE
+	if (num <= DS18B20_CACHE_SIZE)
+	{
+		uint8_t crc, i, bit;
+		
+		_cache[num - 1] = sensor;
+		
+		crc = 0;
+		
+		for (i = 0; i < 8; i++)
+		{
+			crc = _crc_ibutton_update(crc, sensor.addr[i]);
+		}
+		
+		bit = 1 << ((num - 1) & 0x07);
+		
+		if (crc != 0)
+		{
+			_cacheBad[(num - 1) >> 3] |= bit;
+		}
+		else
+		{
+			_cacheBad[(num - 1) >> 3] &= ~bit;
+		}
+	}
+	#endif
 	
-	scratch.temp[TEMP_F] = (scratch.temp[TEMP_C] * 9) / 5;
-	scratch.temp[TEMP_F] += (32 << 4);
+	appendRecord(num, sensor);
 	
-	scratch.alarmHigh = scratch_buf[DS18B20_SCRATCHPAD_HIGH_ALARM];
-	scratch.alarmLow = scratch_buf[DS18B20_SCRATCHPAD_LOW_ALARM];
+	if (num > eepromTotal)
+	{
+		eepromTotal++;
+	}
 	
-	scratch.config = scratch_buf[DS18B20_SCRATCHPAD_CONFIG_REG];
+	#ifdef DS18B20_SENSOR_CACHE
+	hashSensors();
+	#endif
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-//*************************************************************************************************
-//	Onewire temperature sensor management functions
-//*************************************************************************************************
-
+#ifdef DS18B20_SENSOR_CACHE
 //-------------------------------------------------------------------------------------------------
 //
-// Reset the number of sensors to zero (saves total to eeprom)
+// Rebuild the rom lookup buckets from the cache
 //
 //	Input	none
 //
@@ -505,106 +2061,130 @@ void DS18B20::readScratchpad(Device &sensor, Scratch &scratch)
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::resetSensors(void)
+void DS18B20::hashSensors(void)
 {
-	eepromTotal = 0;
-	eeprom_write_byte((uint8_t*)E2END, eepromTotal);
+	uint8_t num, bucket;
+	
+	for (bucket = 0; bucket < DS18B20_HASH_SIZE; bucket++)
+	{
+		_hashHead[bucket] = 0;
+	}
+	
+	num = (eepromTotal < DS18B20_CACHE_SIZE) ? eepromTotal : DS18B20_CACHE_SIZE;
+	
+	// push in reverse so each bucket lists sensors in order
+	for (; num > 0; num--)
+	{
+		bucket = _cache[num - 1].addr[7] & (DS18B20_HASH_SIZE - 1);
+		
+		_hashNext[num - 1] = _hashHead[bucket];
+		_hashHead[bucket] = num;
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Get the total number of sensors stored
+// Forget which channels hold a single device (match rom until a search sees them again)
 //
 //	Input	none
 //
-//	Output	device count
+//	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-uint8_t DS18B20::totalSensors(void)
+void DS18B20::clearSole(void)
 {
-	return eepromTotal;
+	uint8_t channel;
+	
+	for (channel = 0; channel < DS2482_TOTAL_CHANNELS; channel++)
+	{
+		_soleSensor[channel] = 0;
+	}
 }
+#endif
 
 //-------------------------------------------------------------------------------------------------
 //
-// Load sensor data from Eeprom
+// Set how often a stored sensor is polled
 //
 //	Input	num: device number
-//			&sensor: reference to device data
+//			interval: seconds between samples (0 default)
+//			priority: 0 - 3, higher is read first when sensors are due together
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::loadSensor(uint8_t num, DEVICE &sensor)
+void DS18B20::setInterval(uint8_t num, uint8_t interval, uint8_t priority)
 {
-	uint16_t offset;
-	uint8_t crc, i;
+	Device sensor;
 	
 	if (num <= 0 || num > eepromTotal)
 	{
 		return;
 	}
 	
-	offset = num * sizeof(DEVICE);
-	
-	if (offset > DS18B20_EEPROM_MAX_ALLOC)
-	{
-		ds2482.error_flags |= (1 << ERROR_EEPROM_FULL);
-		return;
-	}
-	
-	eeprom_read_block((void*)&sensor, (const void*)(E2END - offset), sizeof(DEVICE));
+	loadSensor(num, sensor);
 	
-	crc = 0;
+	sensor.interval = interval;
+	sensor.config.priority = priority;
 	
-	for (i = 0; i < 8; i++)
-	{
-		crc = _crc_ibutton_update(crc, sensor.addr[i]);
-	}
+	storeSensor(num, sensor);
 	
-	if (crc != 0)
+	#ifdef DS18B20_ISR_POLLING
+	// start the new interval with a sample
+	if (num < DS18B20_BUFFER_SIZE)
 	{
-		ds2482.error_flags |= (1 << ERROR_CRC_MISMATCH);
+		_pollDue[num] = _pollClock;
 	}
+	#endif
 }
 
 //-------------------------------------------------------------------------------------------------
 //
-// Store sensor data to Eeprom
+// Find the stored sensor with a rom id
 //
-//	Input	num: device number
-//			&sensor: reference to device data
+//	Input	*addr: rom id
 //
-//	Output	none
+//	Output	device number (0 not stored)
 //
 //-------------------------------------------------------------------------------------------------
 
-void DS18B20::storeSensor(uint8_t num, DEVICE &sensor)
+uint8_t DS18B20::lookupSensor(uint8_t *addr)
 {
-	uint16_t offset;
-	
-	if (num <= 0 && num > eepromTotal + 1)
-	{
-		return;
-	}
+	Device sensor;
+	uint8_t num;
 	
-	offset = num * sizeof(DEVICE);
+	#ifdef DS18B20_SENSOR_CACHE
+	// the rom crc byte spreads sensors evenly across the buckets
+	num = _hashHead[addr[7] & (DS18B20_HASH_SIZE - 1)];
 	
-	if (offset > DS18B20_EEPROM_MAX_ALLOC)
+	while (num)
 	{
-		ds2482.error_flags |= (1 << ERROR_EEPROM_FULL);
-		return;
+		if (memcmp(_cache[num - 1].addr, addr, 8) == 0)
+		{
+			return num;
+		}
+		
+		num = _hashNext[num - 1];
 	}
 	
-	eeprom_write_block((const void*)&sensor, (void*)(E2END - offset), sizeof(DEVICE));
+	num = DS18B20_CACHE_SIZE + 1;
+	#else
+	num = 1;
+	#endif
 	
-	if (num > eepromTotal)
+	for (; num <= eepromTotal; num++)
 	{
-		eepromTotal++;
-		eeprom_write_byte((uint8_t*)E2END, eepromTotal);
+		fetchSensor(num, sensor);
+		
+		if (memcmp(sensor.addr, addr, 8) == 0)
+		{
+			return num;
+		}
 	}
+	
+	return 0;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -675,80 +2255,182 @@ uint8_t DS18B20::varifySensor(uint8_t num, Device &sensor)
 
 //-------------------------------------------------------------------------------------------------
 //
-// Find devices not stored in eeprom
+// Find devices not stored in eeprom (each call continues the sweep across the channels)
 //
 //	Input	&sensor: reference to device data
 //			&scratch: reference to scratchpad
 //
-//	Output	0 device not found
+//	Output	0 device not found (sweep done, the next call starts over)
 //			1 new device found
 //
 //-------------------------------------------------------------------------------------------------
 
 uint8_t DS18B20::findSensor(Device &sensor, Scratch &scratch)
 {
-	uint8_t channel = 0;
-	
-	ds2482.searchDone = 1;
+	if (_findChannel == DS18B20_FIND_IDLE)
+	{
+		_findChannel = 0;
+		ds2482.searchDone = 1;
+		
+		#ifdef DS18B20_SENSOR_CACHE
+		_findCount = 0;
+		#endif
+	}
+	else if (ds2482.searchDone == 1)
+	{
+		// last call found the final device on its channel
+		findNext();
+	}
 	
-	do
+	while (_findChannel < DS2482_TOTAL_CHANNELS)
 	{
 		#ifdef DS2482_800
-		ds2482.setChannel(channel);
+		ds2482.setChannel(_findChannel);
 		#endif
 		
-		//tempSearch(sensor, scratch);
+		// every family, so all the devices on the channel are counted
+		ds2482.romSearch(sensor.addr, 0);
 		
-		ds2482.romSearch(sensor.addr, DS18B20_FAMILY_CODE);
+		#ifdef DS18B20_SENSOR_CACHE
+		if (ds2482.error_flags == 0)
+		{
+			memcpy(_findRom, sensor.addr, 8);
+			_findCount += (_findCount < 2) ? 1 : 0;
+		}
+		#endif
 		
-		sensor.config.channel = channel;
-		sensor.config.powered = powerMode(sensor) ? 0x01 : 0;
+		// stored sensors are skipped without touching the bus again
+		if (ds2482.error_flags == 0 && sensor.addr[0] == DS18B20_FAMILY_CODE && lookupSensor(sensor.addr) == 0)
+		{
+			sensor.config.channel = _findChannel;
+			sensor.config.powered = powerMode(sensor) ? 0x01 : 0;
+			sensor.config.priority = 0;
+			sensor.interval = 0;
+			
+			readScratchpad(sensor, scratch);
+			sensor.config.resolution = (scratch.config CONFIG_RES_SHIFT) & 0x03;
+			
+			if (ds2482.error_flags == 0)
+			{
+				return 1;
+			}
+		}
 		
-		readScratchpad(sensor, scratch);
-		sensor.config.resolution = (scratch.config CONFIG_RES_SHIFT) & 0x03;
+		if (ds2482.error_flags)
+		{
+			ds2482.error_flags &= ~(1 << ERROR_NO_DEVICE);
+			
+			if (ds2482.error_flags)
+			{
+				#ifdef DS18B20_SENSOR_CACHE
+				_soleSensor[_findChannel] = 0;
+				#endif
+				break;
+			}
+		}
 		
-		if (ds2482.error_flags == 0)
+		if (ds2482.searchDone == 1)
+		{
+			findNext();
+		}
+	}
+	
+	_findChannel = DS18B20_FIND_IDLE;
+	
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Move the sweep to the next channel, noting the stored sensor if the search saw it alone
+//		(a sensor found alone and stored by the caller is known by now)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS18B20::findNext(void)
+{
+	#ifdef DS18B20_SENSOR_CACHE
+	uint8_t num = (_findCount == 1) ? lookupSensor(_findRom) : 0;
+	
+	// sensors past the cache are not checked against their address
+	_soleSensor[_findChannel] = (num <= DS18B20_CACHE_SIZE) ? num : 0;
+	_findCount = 0;
+	#endif
+	
+	_findChannel++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Find stored sensors in alarm with the conditional search (each call continues the sweep)
+//		(start conversions on every channel and wait for them before the sweep, only sensors
+//		at or past their alarm limits answer so the others are never read)
+//
+//	Input	&sensor: reference to device data
+//			&scratch: reference to scratchpad
+//
+//	Output	0 no more sensors in alarm (sweep done, the next call starts over)
+//			device number of a sensor in alarm (scratchpad read)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS18B20::alarmSensor(Device &sensor, Scratch &scratch)
+{
+	uint8_t num;
+	
+	if (_alarmChannel == DS18B20_FIND_IDLE)
+	{
+		_alarmChannel = 0;
+		ds2482.searchDone = 1;
+	}
+	else if (ds2482.searchDone == 1)
+	{
+		// last call found the final sensor in alarm on its channel
+		_alarmChannel++;
+	}
+	
+	while (_alarmChannel < DS2482_TOTAL_CHANNELS)
+	{
+		#ifdef DS2482_800
+		ds2482.setChannel(_alarmChannel);
+		#endif
+		
+		ds2482.romAlarmSearch(sensor.addr, DS18B20_FAMILY_CODE);
+		
+		// sensors not stored are left to findSensor
+		if (ds2482.error_flags == 0 && (num = lookupSensor(sensor.addr)) != 0)
 		{
-			uint8_t num, romByte;
-			num = 1;
+			loadSensor(num, sensor);
+			readScratchpad(sensor, scratch);
 			
-			do
+			if (ds2482.error_flags == 0)
 			{
-				Device device;
-				
-				if (num > eepromTotal)
-				{
-					return 1;
-				}
-				
-				romByte = 0;
-				loadSensor(num, device);
-				
-				while (romByte < 8 && sensor.addr[romByte] == device.addr[romByte])
-				{
-					romByte++;
-				}
-				
-				num++;
+				return num;
 			}
-			while (romByte < 8);
 		}
-		else
+		
+		if (ds2482.error_flags)
 		{
+			// an empty channel or one without alarms
 			ds2482.error_flags &= ~(1 << ERROR_NO_DEVICE);
 			
 			if (ds2482.error_flags)
 			{
-				return 0;
+				break;
 			}
 		}
 		
 		if (ds2482.searchDone == 1)
 		{
-			channel++;
+			_alarmChannel++;
 		}
 	}
-	while (ds2482.searchDone != 1 || channel < DS2482_TOTAL_CHANNELS);
+	
+	_alarmChannel = DS18B20_FIND_IDLE;
 	
 	return 0;
 }
@@ -765,7 +2447,6 @@ uint8_t DS18B20::findSensor(Device &sensor, Scratch &scratch)
 
 
 
-
 //-------------------------------------------------------------------------------------------------
 //
 // DS18B20 initalization
@@ -781,21 +2462,70 @@ void DS18B20::init(void)
 	uint8_t count;
 	Device sensor;
 	
-	eepromTotal = eeprom_read_byte((const uint8_t*)E2END);
+	scanStore();
 	
-	if (eepromTotal > (DS18B20_EEPROM_MAX_ALLOC / sizeof(DEVICE)))
+	#ifdef DS18B20_SENSOR_CACHE
+	// one eeprom pass, then sensor lookups come from ram
+	for (count = 0; count < DS18B20_CACHE_SIZE; count++)
 	{
-		eepromTotal = 0;
+		uint8_t bit = 1 << (count & 0x07);
+		
+		_cacheBad[count >> 3] &= ~bit;
+		
+		if (count < eepromTotal && fetchSensor(count + 1, _cache[count]) != 0)
+		{
+			_cacheBad[count >> 3] |= bit;
+		}
 	}
 	
+	hashSensors();
+	clearSole();
+	#endif
+	
+	_findChannel = DS18B20_FIND_IDLE;
+	_alarmChannel = DS18B20_FIND_IDLE;
+	
 	#ifdef DS18B20_ISR_POLLING
 	isr_flags = (TEMP_F << ISR_FLAG_UNITS);
+	isr_ticks = 0;
+	
+	// every sensor is due on the first update
+	_pollState = POLL_IDLE;
+	_pollJob = POLL_JOB_NONE;
+	_pollTick = 0;
+	_pollClock = 0;
+	
+	for (count = 0; count < DS2482_TOTAL_CHANNELS; count++)
+	{
+		_convertStart[count] = 0;
+		_convertResolution[count] = 3;
+	}
 	
 	for (count = 0; count < DS18B20_BUFFER_SIZE; count++)
 	{
 		temps[count] = 0;
+		_pollTemps[count] = 0;
+		_pollTimes[count] = 0;
+		_tempsTimes[count] = 0;
+		_pollDue[count] = 0;
+		
+		// until the first read, assume the slowest conversion
+		_sensorResolution[count] = 3;
+		_sensorCelsius[count] = 0;
+	}
+	
+	for (count = 0; count < sizeof(_pollValid); count++)
+	{
+		_pollValid[count] = 0;
+		_tempsValid[count] = 0;
 	}
 	
+	_tempsSequence = 0;
+	
+	#ifdef DS18B20_HISTORY
+	clearHistory();
+	#endif
+	
 	// Timer1 Initialization (CTC Mode)
 	// Reset the registers for timer 1
 	TIMER1_CONTROL_REGISTER_A = 0;
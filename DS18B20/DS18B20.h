@@ -62,6 +62,15 @@
 //	Libraries
 //*************************************************************************************************
 
+#include <DS2482.h>
+
+extern "C"
+{
+	#include <string.h>
+}
+
+// the DS2482 emulator also stands in for the avr eeprom and timer
+#ifndef DS2482_EMULATOR
 extern "C"
 {
 	#include <inttypes.h>
@@ -70,8 +79,8 @@ extern "C"
 	#include <util/delay.h>
 	#include <util/crc16.h>
 }
+#endif
 
-#include <DS2482.h>
 #include "DS18B20_Commands.h"
 
 
@@ -80,10 +89,92 @@ extern "C"
 //*************************************************************************************************
 
 #define DS18B20_ISR_POLLING
-#define DS18B20_BUFFER_SIZE			32
 
+// polling schedule
+#define DS18B20_DEFAULT_INTERVAL	10			// seconds, for sensors with interval 0
+#define DS18B20_PRIORITY_SECONDS	2			// each priority level counts as this late
+
+// adaptive resolution (ISR_FLAG_ADAPTIVE)
+#define DS18B20_MIN_RESOLUTION		0			// stable sensors go down to 9 bit
+#define DS18B20_MOVING_CHANGE		8			// a 1/2 degree change goes back to 12 bit
+#define DS18B20_ALARM_MARGIN		2			// degrees from an alarm limit kept at 12 bit
 
+// rolling history and trend of each sensor's readings (12 + 4 * depth bytes of ram per sensor)
+#define DS18B20_HISTORY
+
+#if RAMEND > 0x8FF
+#define DS18B20_HISTORY_DEPTH		8			// readings kept
+#else
+#define DS18B20_HISTORY_DEPTH		4			// 2k ram (atmega328p)
+#endif
+
+// keep the stored sensors in ram (write through to eeprom, 11 bytes of ram per sensor)
+#define DS18B20_SENSOR_CACHE
+#define DS18B20_HASH_SIZE			16			// rom lookup buckets (power of 2)
+
+// findSensor / alarmSensor channel when no search is in progress
+#define DS18B20_FIND_IDLE			0xFF
+
+
+// sensor store, a journal of records in the top half of the eeprom
 #define DS18B20_EEPROM_MAX_ALLOC	(E2END >> 1)
+#define DS18B20_RECORD_SIZE			14			// sizeof(STORE_RECORD)
+#define DS18B20_STORE_START			(E2END + 1 - DS18B20_EEPROM_MAX_ALLOC)
+#define DS18B20_STORE_SLOTS			(DS18B20_EEPROM_MAX_ALLOC / DS18B20_RECORD_SIZE)
+#define DS18B20_STORE_RESET			0			// record number that clears the table
+#define DS18B20_STORE_NONE			0xFF
+
+
+// sensor capacity, sensors are numbered 1 to DS18B20_MAX_SENSORS (sensor 0 is never used)
+//	set it here (DS18B20.cpp is compiled on its own and never sees a sketch's defines),
+//	otherwise it is what half the ram and the eeprom store can hold
+#ifdef DS18B20_MAX_SENSORS
+#error "DS18B20 capacity is set by DS18B20_MAX_SENSORS in DS18B20.h, not before including it"
+#endif
+
+//#define DS18B20_MAX_SENSORS			70
+
+#ifndef DS18B20_MAX_SENSORS
+
+#define DS18B20_RAM_SHARE			((RAMEND + 1 - 0x100) >> 1)		// ram starts at 0x100
+#define DS18B20_SENSOR_RAM			14			// temps, sample times, polling and store index
+
+#ifdef DS18B20_SENSOR_CACHE
+#define DS18B20_CACHE_RAM			11
+#else
+#define DS18B20_CACHE_RAM			0
+#endif
+
+#ifdef DS18B20_HISTORY
+#define DS18B20_HISTORY_RAM			(12 + 4 * DS18B20_HISTORY_DEPTH)
+#else
+#define DS18B20_HISTORY_RAM			0
+#endif
+
+#define DS18B20_RAM_SENSORS			(DS18B20_RAM_SHARE / (DS18B20_SENSOR_RAM + DS18B20_CACHE_RAM + DS18B20_HISTORY_RAM))
+#define DS18B20_STORE_SENSORS		(DS18B20_STORE_SLOTS - 2)		// compaction needs two free slots
+
+#if DS18B20_RAM_SENSORS < DS18B20_STORE_SENSORS
+#define DS18B20_FIT_SENSORS			DS18B20_RAM_SENSORS
+#else
+#define DS18B20_FIT_SENSORS			DS18B20_STORE_SENSORS
+#endif
+
+#if DS18B20_FIT_SENSORS > 254
+#define DS18B20_MAX_SENSORS			254			// sensor numbers are a byte
+#else
+#define DS18B20_MAX_SENSORS			DS18B20_FIT_SENSORS
+#endif
+
+#endif
+
+#if DS18B20_MAX_SENSORS > 254 || DS18B20_MAX_SENSORS + 2 > DS18B20_STORE_SLOTS || DS18B20_STORE_SLOTS >= DS18B20_STORE_NONE
+#error "DS18B20_MAX_SENSORS does not fit the sensor numbers or the eeprom store"
+#endif
+
+// per sensor arrays are indexed by sensor number
+#define DS18B20_BUFFER_SIZE			(DS18B20_MAX_SENSORS + 1)
+#define DS18B20_CACHE_SIZE			DS18B20_MAX_SENSORS
 
 #define TEMP_C						0
 #define TEMP_F						1
@@ -113,8 +204,12 @@ extern "C"
 
 // ISR flag bits
 #define ISR_FLAG_UNITS				0
+#define ISR_FLAG_ADAPTIVE			1
 #define ISR_FLAG_NEW_TEMPS			7
 
+// last read of the sensor succeeded (its temp was converted at snap.times[num])
+#define SNAPSHOT_VALID(snap, num)	((snap).valid[(num) >> 3] & (1 << ((num) & 0x07)))
+
 
 
 
@@ -131,9 +226,19 @@ typedef struct Device
 		uint8_t powered		:1;
 		uint8_t channel		:3;
 		uint8_t resolution	:2;
+		uint8_t priority	:2;
 	} config;
+	uint8_t interval;			// seconds between samples (0 default)
 } DEVICE;
 
+typedef struct StoreRecord
+{
+	uint16_t sequence;			// counts every record written
+	uint8_t num;				// sensor number (DS18B20_STORE_RESET clears the table)
+	DEVICE sensor;
+	uint8_t crc;				// crc of the whole record
+} STORE_RECORD;
+
 typedef struct Scratch
 {
 	int16_t temp[2];
@@ -142,6 +247,43 @@ typedef struct Scratch
 	uint8_t config;
 } SCRATCH;
 
+typedef struct Snapshot
+{
+	uint8_t sequence;								// changes each polling round (start at 0)
+	uint8_t valid[(DS18B20_BUFFER_SIZE + 7) >> 3];	// bit per sensor whose last read succeeded
+	int16_t temps[DS18B20_BUFFER_SIZE];
+	uint16_t times[DS18B20_BUFFER_SIZE];			// scheduler clock of each sensor's last good conversion
+} SNAPSHOT;
+
+typedef struct Sample
+{
+	int16_t temp;
+	uint16_t time;				// scheduler clock of the conversion
+} SAMPLE;
+
+typedef struct History
+{
+	SAMPLE samples[DS18B20_HISTORY_DEPTH];
+	uint8_t head;				// next sample written (the oldest once full)
+	uint8_t count;
+	int32_t sum;
+	int16_t min;
+	int16_t max;
+	int16_t slope;
+} HISTORY;
+
+typedef struct Trend
+{
+	uint8_t count;				// readings the statistics cover
+	int16_t latest;
+	int16_t min;
+	int16_t max;
+	int16_t mean;
+	int16_t slope;				// change per minute (temps[] units, least squares fit)
+	uint16_t span;				// seconds from the oldest to the latest reading
+	uint16_t age;				// seconds since the latest reading
+} TREND;
+
 
 
 
@@ -157,8 +299,19 @@ class DS18B20
 		#ifdef DS18B20_ISR_POLLING
 		volatile uint16_t temps[DS18B20_BUFFER_SIZE];
 		volatile uint8_t isr_flags;
+		volatile uint8_t isr_ticks;
 		
 		void polling(uint8_t);
+		uint8_t update(void);
+		uint8_t snapshot(Snapshot&);
+		uint16_t snapshotAge(Snapshot&, uint8_t);
+		
+		uint8_t sensorChannels(uint8_t);
+		
+		#ifdef DS18B20_HISTORY
+		uint8_t trend(uint8_t, Trend&);
+		uint8_t history(uint8_t, uint8_t, int16_t&, uint16_t&);
+		#endif
 		#endif
 		
 		void startConversion(uint8_t);
@@ -175,20 +328,129 @@ class DS18B20
 		void loadSensor(uint8_t, Device&);
 		void storeSensor(uint8_t, Device&);
 		
+		void setInterval(uint8_t, uint8_t, uint8_t);
+		
+		uint8_t lookupSensor(uint8_t*);
+		
 		uint8_t varifySensor(uint8_t, Device&);
 		uint8_t findSensor(Device&, Scratch&);
+		uint8_t alarmSensor(Device&, Scratch&);
 		
 		void init(void);
 		
 	private:
 		uint8_t eepromTotal;
 		
+		// journal position and the slot of each sensor's latest record
+		uint16_t _storeSequence;
+		uint8_t _storeHead;
+		uint8_t _storeSlot[DS18B20_BUFFER_SIZE];
+		
+		uint8_t readRecord(uint8_t, StoreRecord&);
+		void writeRecord(uint8_t, Device&);
+		uint8_t storeLive(uint8_t);
+		uint8_t storeFree(void);
+		void appendRecord(uint8_t, Device&);
+		void scanStore(void);
+		
+		#ifdef DS18B20_SENSOR_CACHE
+		DEVICE _cache[DS18B20_CACHE_SIZE];
+		uint8_t _cacheBad[(DS18B20_CACHE_SIZE + 7) >> 3];
+		
+		uint8_t _hashHead[DS18B20_HASH_SIZE];
+		uint8_t _hashNext[DS18B20_CACHE_SIZE];
+		
+		// the stored sensor a search this session saw alone on each channel (0 none or unknown)
+		uint8_t _soleSensor[DS2482_TOTAL_CHANNELS];
+		
+		// roms the sweep has seen on the current channel, and the last one
+		uint8_t _findCount;
+		uint8_t _findRom[8];
+		
+		void hashSensors(void);
+		void clearSole(void);
+		#endif
+		
+		uint8_t _findChannel;
+		uint8_t _alarmChannel;
+		
+		void findNext(void);
+		
+		#ifdef DS18B20_ISR_POLLING
+		uint8_t _pollState;
+		uint8_t _pollTick;
+		uint16_t _pollClock;
+		uint16_t _pollRound;
+		uint8_t _pollStart;
+		uint8_t _pollConverting;
+		uint8_t _pollPowered;
+		uint8_t _pollReady;
+		uint8_t _pollCheck;
+		uint16_t _pollChecked;
+		
+		// bus work queued on the DS2482 for the current step
+		uint8_t _pollJob;
+		uint8_t _pollJobChannel;
+		uint8_t _pollJobNum;
+		uint8_t _pollJobIndex;
+		uint8_t _pollJobResolution;
+		
+		// conversion tracker (scheduler clock and resolution of each channel's last start)
+		uint16_t _convertStart[DS2482_TOTAL_CHANNELS];
+		uint8_t _convertResolution[DS2482_TOTAL_CHANNELS];
+		
+		// resolution each sensor converts at now and its last reading in C (1/16 degree)
+		uint8_t _sensorResolution[DS18B20_BUFFER_SIZE];
+		int16_t _sensorCelsius[DS18B20_BUFFER_SIZE];
+		
+		// next sample of each sensor (scheduler clock)
+		uint16_t _pollDue[DS18B20_BUFFER_SIZE];
+		
+		// the round being read, published to temps[] when it is done
+		int16_t _pollTemps[DS18B20_BUFFER_SIZE];
+		uint8_t _pollValid[(DS18B20_BUFFER_SIZE + 7) >> 3];
+		uint16_t _pollTimes[DS18B20_BUFFER_SIZE];
+		
+		// volatile so the copies stay between the sequence changes
+		volatile uint8_t _tempsSequence;
+		volatile uint8_t _tempsValid[(DS18B20_BUFFER_SIZE + 7) >> 3];
+		volatile uint16_t _tempsTimes[DS18B20_BUFFER_SIZE];
+		
+		void pollClock(void);
+		uint16_t intervalTicks(Device&);
+		uint8_t scheduleSensors(void);
+		uint8_t nextSensor(void);
+		void startJob(uint8_t);
+		void finishJob(void);
+		void startChannel(uint8_t);
+		uint8_t conversionReady(uint8_t);
+		void checkChannel(uint8_t);
+		void readSensor(uint8_t);
+		void sensorRead(uint8_t);
+		uint8_t nearAlarm(int8_t, uint8_t);
+		void adaptResolution(uint8_t, Device&, Scratch&, int16_t);
+		void publishTemps(void);
+		
+		#ifdef DS18B20_HISTORY
+		HISTORY _history[DS18B20_BUFFER_SIZE];
+		
+		void recordHistory(uint8_t, int16_t);
+		void clearHistory(void);
+		#endif
+		#endif
+		
 		uint8_t powerMode(void);
 		uint8_t powerMode(Device&);
 		
 		void storeSensorEE(Device&);
 		void loadSensorEE(Device&);
 		
+		uint8_t fetchSensor(uint8_t, Device&);
+		uint8_t soleSensor(Device&);
+		void selectSensor(Device&);
+		void sendScratchpad(Device&, Scratch&);
+		void decodeScratchpad(uint8_t*, Scratch&);
+		
 };
 
 extern DS18B20 dsTemp;
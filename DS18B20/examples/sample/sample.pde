@@ -7,6 +7,7 @@
 
 Device device;
 Scratch scratchpad;
+Snapshot temps;
 
 char strBuffer[32];
 char *strErrors[] =
@@ -108,7 +109,15 @@ void setup()
     }
     
     dsTemp.storeSensor(totalDevices + 1, device);
-    totalDevices++;
+    
+    // no room for more sensors, so stop enrolling
+    if (ds2482.error_flags & (1 << ERROR_EEPROM_FULL))
+    {
+      showErrors();
+      break;
+    }
+    
+    totalDevices = dsTemp.totalSensors();
     
     LCD.textTo(2, 2 + totalDevices);
     LCD.text("Sensor ");
@@ -137,17 +146,23 @@ void loop()
 {
   uint8_t count;
   
-  if (dsTemp.isr_flags & (1 << ISR_FLAG_NEW_TEMPS))
+  // bus work for the polling tick
+  dsTemp.update();
+  
+  if (dsTemp.snapshot(temps))
   {
-    dsTemp.isr_flags &= ~(1 << ISR_FLAG_NEW_TEMPS);
-    
     for (count = 1; count <= totalDevices; count++)
     {
       uint16_t temp, frac;
       
-      cli();
-      temp = dsTemp.temps[count];
-      sei();
+      if (!SNAPSHOT_VALID(temps, count))
+      {
+        LCD.textTo(24, 2 + count);
+        LCD.text("--        ");
+        continue;
+      }
+      
+      temp = temps.temps[count];
       
       LCD.textTo(24, 2 + count);
       LCD.text(itoa(temp/16, strBuffer, 10));
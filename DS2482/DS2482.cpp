@@ -170,8 +170,6 @@ void DS2482::_busy(uint8_t set)
 
 void DS2482::setConfig(uint8_t config)
 {
-	uint8_t tmp;
-	
 	_busy(1);
 	
 	if (error_flags)
@@ -179,6 +177,23 @@ void DS2482::setConfig(uint8_t config)
 		return;
 	}
 	
+	_writeConfig(config);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Write configuration to chip once the onewire line is idle
+//
+//	Input	config: configuration nibble
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::_writeConfig(uint8_t config)
+{
+	uint8_t tmp;
+	
 	tmp = ((~config) << 4) | (config & 0x0F);
 	
 	i2c_start_wait(_address | I2C_WRITE);
@@ -193,6 +208,33 @@ void DS2482::setConfig(uint8_t config)
 	{
 		error_flags |= (1 << ERROR_CONFIG);
 	}
+	else
+	{
+		// strong pullup clears itself after the next onewire command
+		_config = config & ~DS2482_CONFIG_SPU;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Set onewire speed (keeps the rest of the configuration)
+//
+//	Input	overdrive: 0 standard speed, 1 overdrive speed
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::setSpeed(uint8_t overdrive)
+{
+	uint8_t config;
+	
+	config = (overdrive) ? (_config | DS2482_CONFIG_WS) : (_config & ~DS2482_CONFIG_WS);
+	
+	if (config != _config)
+	{
+		setConfig(config);
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -208,77 +250,92 @@ void DS2482::setConfig(uint8_t config)
 #ifdef DS2482_800
 uint8_t DS2482::setChannel(uint8_t channel)
 {
-	uint8_t check, tmp;
-	
 	if (channel < DS2482_TOTAL_CHANNELS && _channel != channel)
 	{
 		_busy(1);
 		
 		if (error_flags == 0)
 		{
-			i2c_start_wait(_address | I2C_WRITE);
-			i2c_write(DS2482_SELECT_CHANNEL);
+			_selectChannel(channel);
+		}
+	}
+	
+	return _channel;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Select chip channel once the onewire line is idle
+//
+//	Input	channel: one wire channel
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::_selectChannel(uint8_t channel)
+{
+	uint8_t check, tmp;
+	
+	i2c_start_wait(_address | I2C_WRITE);
+	i2c_write(DS2482_SELECT_CHANNEL);
+	
+	switch(channel)
+	{
+		default:
+		case 0:
+			i2c_write(DS2482_WRITE_CHANNEL_0);
+			check = DS2482_READ_CHANNEL_0;
+			break;
 			
-			switch(channel)
-			{
-				default:
-				case 0:
-					i2c_write(DS2482_WRITE_CHANNEL_0);
-					check = DS2482_READ_CHANNEL_0;
-					break;
-					
-				case 1:
-					i2c_write(DS2482_WRITE_CHANNEL_1);
-					check = DS2482_READ_CHANNEL_1;
-					break;
-					
-				case 2:
-					i2c_write(DS2482_WRITE_CHANNEL_2);
-					check = DS2482_READ_CHANNEL_2;
-					break;
-					
-				case 3:
-					i2c_write(DS2482_WRITE_CHANNEL_3);
-					check = DS2482_READ_CHANNEL_3;
-					break;
-					
-				case 4:
-					i2c_write(DS2482_WRITE_CHANNEL_4);
-					check = DS2482_READ_CHANNEL_4;
-					break;
-					
-				case 5:
-					i2c_write(DS2482_WRITE_CHANNEL_5);
-					check = DS2482_READ_CHANNEL_5;
-					break;
-					
-				case 6:
-					i2c_write(DS2482_WRITE_CHANNEL_6);
-					check = DS2482_READ_CHANNEL_6;
-					break;
-					
-				case 7:
-					i2c_write(DS2482_WRITE_CHANNEL_7);
-					check = DS2482_READ_CHANNEL_7;
-					break;
-			}
+		case 1:
+			i2c_write(DS2482_WRITE_CHANNEL_1);
+			check = DS2482_READ_CHANNEL_1;
+			break;
 			
-			i2c_rep_start(_address | I2C_READ);
-			tmp = i2c_readNak();
-			i2c_stop();
+		case 2:
+			i2c_write(DS2482_WRITE_CHANNEL_2);
+			check = DS2482_READ_CHANNEL_2;
+			break;
 			
-			if (tmp == check)
-			{
-				_channel = channel;
-			}
-			else
-			{
-				error_flags |= (1 << ERROR_CHANNEL);
-			}
-		}
+		case 3:
+			i2c_write(DS2482_WRITE_CHANNEL_3);
+			check = DS2482_READ_CHANNEL_3;
+			break;
+			
+		case 4:
+			i2c_write(DS2482_WRITE_CHANNEL_4);
+			check = DS2482_READ_CHANNEL_4;
+			break;
+			
+		case 5:
+			i2c_write(DS2482_WRITE_CHANNEL_5);
+			check = DS2482_READ_CHANNEL_5;
+			break;
+			
+		case 6:
+			i2c_write(DS2482_WRITE_CHANNEL_6);
+			check = DS2482_READ_CHANNEL_6;
+			break;
+			
+		case 7:
+			i2c_write(DS2482_WRITE_CHANNEL_7);
+			check = DS2482_READ_CHANNEL_7;
+			break;
 	}
 	
-	return _channel;
+	i2c_rep_start(_address | I2C_READ);
+	tmp = i2c_readNak();
+	i2c_stop();
+	
+	if (tmp == check)
+	{
+		_channel = channel;
+	}
+	else
+	{
+		error_flags |= (1 << ERROR_CHANNEL);
+	}
 }
 #endif
 
@@ -564,6 +621,78 @@ void DS2482::romSkip(void)
 	wireWrite(ONE_WIRE_SKIP_ROM);
 }
 
+//-------------------------------------------------------------------------------------------------
+//
+// Resume the device selected by the last match (only devices with the resume command)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::romResume(void)
+{
+	wireReset();
+	wireWrite(ONE_WIRE_RESUME);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Skip rom address and put all overdrive capable devices in overdrive
+//		(stays in overdrive until setSpeed(0), the next reset then returns the bus to standard speed)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::romOverdriveSkip(void)
+{
+	setSpeed(0);
+	wireReset();
+	wireWrite(ONE_WIRE_OVERDRIVE_SKIP);
+	
+	if (error_flags)
+	{
+		return;
+	}
+	
+	setSpeed(1);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get device with rom address and put it in overdrive (address is sent at overdrive speed)
+//
+//	Input	*address: pointer to 8 byte device rom buffer
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::romOverdriveMatch(uint8_t *address)
+{
+	uint8_t i;
+	
+	setSpeed(0);
+	wireReset();
+	wireWrite(ONE_WIRE_OVERDRIVE_MATCH);
+	
+	if (error_flags)
+	{
+		return;
+	}
+	
+	setSpeed(1);
+	
+	for (i = 0; i < 8; i++)
+	{
+		wireWrite(address[i]);
+	}
+}
+
 //-------------------------------------------------------------------------------------------------
 //
 // Search OneWire for devices
@@ -576,6 +705,40 @@ void DS2482::romSkip(void)
 //-------------------------------------------------------------------------------------------------
 
 void DS2482::romSearch(uint8_t *address, uint8_t family)
+{
+	_search(address, family, ONE_WIRE_SEARCH_ROM);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Search OneWire for devices with their alarm flag set (conditional search)
+//		(ERROR_NO_DEVICE when none are in alarm, don't mix with a romSearch in progress)
+//
+//	Input	*address: pointer to 8 byte device rom buffer
+//			family: family of device to find, = 0 for all devices
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::romAlarmSearch(uint8_t *address, uint8_t family)
+{
+	_search(address, family, ONE_WIRE_ALARM_SEARCH);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Step the search to the next device
+//
+//	Input	*address: pointer to 8 byte device rom buffer
+//			family: family of device to find, = 0 for all devices
+//			command: search rom command
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::_search(uint8_t *address, uint8_t family, uint8_t command)
 {
 	uint8_t lastZero, count, crc, i;
 	
@@ -601,7 +764,7 @@ void DS2482::romSearch(uint8_t *address, uint8_t family)
 	}
 	
 	wireReset();
-	wireWrite(ONE_WIRE_SEARCH_ROM);
+	wireWrite(command);
 	
 	if (error_flags)
 	{
@@ -637,7 +800,8 @@ void DS2482::romSearch(uint8_t *address, uint8_t family)
 			
 			if (sbr && tsb)
 			{
-				error_flags |= (1 << ERROR_SEARCH);
+				// nothing took part (all devices out of the conditional search)
+				error_flags |= (count == 0) ? (1 << ERROR_NO_DEVICE) : (1 << ERROR_SEARCH);
 				
 				searchDone = 1;
 				return;
@@ -713,6 +877,370 @@ void DS2482::romSearch(uint8_t *address, uint8_t family)
 
 
 
+
+//*************************************************************************************************
+//	Onewire queue functions
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Empty the onewire queue
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueClear(void)
+{
+	queueTotal = 0;
+	_queueNext = 0;
+	_queueState = DS2482_QUEUE_IDLE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Add an operation to the onewire queue
+//
+//	Input	command: DS2482 command
+//			data: parameter byte
+//
+//	Output	index of the operation (DS2482_QUEUE_FULL if no room)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS2482::queueAdd(uint8_t command, uint8_t data)
+{
+	if (queueTotal >= DS2482_QUEUE_SIZE)
+	{
+		return DS2482_QUEUE_FULL;
+	}
+	
+	queue[queueTotal].command = command;
+	queue[queueTotal].data = data;
+	
+	return queueTotal++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a configuration write
+//
+//	Input	config: configuration nibble
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueConfig(uint8_t config)
+{
+	queueAdd(DS2482_WRITE_CONFIG, config);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a channel change
+//
+//	Input	channel: one wire channel
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+#ifdef DS2482_800
+void DS2482::queueChannel(uint8_t channel)
+{
+	queueAdd(DS2482_SELECT_CHANNEL, channel);
+}
+#endif
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a OneWire reset
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueReset(void)
+{
+	queueAdd(DS2482_ONE_WIRE_RESET, 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a byte write
+//
+//	Input	data: byte to write
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueWrite(uint8_t data)
+{
+	queueAdd(DS2482_ONE_WIRE_WRITE_BYTE, data);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a byte read
+//
+//	Input	none
+//
+//	Output	index of the operation (byte is in queue[index].data when done)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS2482::queueRead(void)
+{
+	return queueAdd(DS2482_ONE_WIRE_READ_BYTE, 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a bit read
+//
+//	Input	none
+//
+//	Output	index of the operation (bit is in queue[index].data when done)
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS2482::queueReadBit(void)
+{
+	return queueAdd(DS2482_ONE_WIRE_SINGLE_BIT, 0x80);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a reset and rom match
+//
+//	Input	*address: pointer to 8 byte device rom buffer
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueMatch(uint8_t *address)
+{
+	uint8_t i;
+	
+	queueReset();
+	queueWrite(ONE_WIRE_MATCH_ROM);
+	
+	for (i = 0; i < 8; i++)
+	{
+		queueWrite(address[i]);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Queue a reset and rom skip
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueSkip(void)
+{
+	queueReset();
+	queueWrite(ONE_WIRE_SKIP_ROM);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Start running the queue (call queuePoll until it returns 0)
+//		(the first poll waits for the line to finish a blocking call)
+//
+//	Input	done: function to call when the queue finishes, or 0
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::queueStart(void (*done)(void))
+{
+	_queueDone = done;
+	_queueNext = 0;
+	_queueTimeout = DS2482_QUEUE_TIMEOUT;
+	_queueState = (queueTotal) ? DS2482_QUEUE_START : DS2482_QUEUE_IDLE;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Advance the queue without waiting on the onewire line
+//		(config and channel ops are issued as soon as the op before them is done)
+//
+//	Input	none
+//
+//	Output	0 queue finished (check error_flags)
+//			1 queue running
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t DS2482::queuePoll(void)
+{
+	while (_queueState != DS2482_QUEUE_IDLE)
+	{
+		WireOp &op = queue[_queueNext];
+		
+		if (_queueState == DS2482_QUEUE_START)
+		{
+			// the pointer may be left on another register by a blocking call
+			_status = _getRegister(DS2482_STATUS_REG);
+			
+			if (_status & DS2482_STATUS_BUSY)
+			{
+				if (--_queueTimeout == 0)
+				{
+					error_flags |= (1 << ERROR_TIMEOUT);
+					_queueFinish();
+					break;
+				}
+				
+				return 1;
+			}
+			
+			_queueState = DS2482_QUEUE_ISSUE;
+			continue;
+		}
+		
+		if (_queueState == DS2482_QUEUE_ISSUE)
+		{
+			if (error_flags)
+			{
+				_queueFinish();
+				break;
+			}
+			
+			switch (op.command)
+			{
+				case DS2482_WRITE_CONFIG:
+					_writeConfig(op.data);
+					break;
+					
+				#ifdef DS2482_800
+				case DS2482_SELECT_CHANNEL:
+					if (op.data < DS2482_TOTAL_CHANNELS && _channel != op.data)
+					{
+						_selectChannel(op.data);
+					}
+					break;
+				#endif
+					
+				default:
+					i2c_start_wait(_address | I2C_WRITE);
+					i2c_write(op.command);
+					
+					if (op.command != DS2482_ONE_WIRE_RESET && op.command != DS2482_ONE_WIRE_READ_BYTE)
+					{
+						i2c_write(op.data);
+					}
+					
+					i2c_stop();
+					
+					// check back on the next poll
+					_queueState = DS2482_QUEUE_WAIT;
+					_queueTimeout = DS2482_QUEUE_TIMEOUT;
+					return 1;
+			}
+		}
+		else
+		{
+			_status = _getRegister(0);
+			
+			if (_status & DS2482_STATUS_BUSY)
+			{
+				if (--_queueTimeout == 0)
+				{
+					error_flags |= (1 << ERROR_TIMEOUT);
+					_queueFinish();
+					break;
+				}
+				
+				return 1;
+			}
+			
+			switch (op.command)
+			{
+				case DS2482_ONE_WIRE_RESET:
+					if (_status & DS2482_STATUS_SD)
+					{
+						error_flags |= (1 << ERROR_SHORT_FOUND);
+					}
+					
+					if (!(_status & DS2482_STATUS_PPD))
+					{
+						error_flags |= (1 << ERROR_NO_DEVICE);
+					}
+					break;
+					
+				case DS2482_ONE_WIRE_READ_BYTE:
+					op.data = _getRegister(DS2482_DATA_REG);
+					break;
+					
+				case DS2482_ONE_WIRE_SINGLE_BIT:
+					op.data = (_status & DS2482_STATUS_SBR) ? 1 : 0;
+					break;
+			}
+			
+			_queueState = DS2482_QUEUE_ISSUE;
+		}
+		
+		if (++_queueNext >= queueTotal)
+		{
+			_queueFinish();
+		}
+	}
+	
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Stop the queue and call the done function
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void DS2482::_queueFinish(void)
+{
+	_queueState = DS2482_QUEUE_IDLE;
+	
+	if (_queueDone)
+	{
+		_queueDone();
+	}
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
 
 //-------------------------------------------------------------------------------------------------
 //
@@ -732,11 +1260,14 @@ void DS2482::init(uint8_t address)
 	_reset();
 	
 	error_flags = 0;
+	_config = 0;
 	
 	setConfig(0);
 	
 	searchLast = 0;
 	searchDone = 1;
+	
+	queueClear();
 }
 
 
@@ -61,12 +61,19 @@
 //	Libraries
 //*************************************************************************************************
 
+// build on the host against a software model of the bridge and sensors
+//#define DS2482_EMULATOR
+
 extern "C"
 {
 	#include <inttypes.h>
+	#ifdef DS2482_EMULATOR
+	#include "utility/DS2482_Emulator.h"
+	#else
 	#include <util/delay.h>
 	#include <util/crc16.h>
 	#include "utility/i2cmaster.h"
+	#endif
 }
 
 #include "DS2482_Commands.h"
@@ -103,9 +110,32 @@ extern "C"
 
 #endif
 
+// onewire queue
+#define DS2482_QUEUE_SIZE			24
+#define DS2482_QUEUE_TIMEOUT		1000
+#define DS2482_QUEUE_FULL			0xFF
+
+#define DS2482_QUEUE_IDLE			0
+#define DS2482_QUEUE_START			1
+#define DS2482_QUEUE_ISSUE			2
+#define DS2482_QUEUE_WAIT			3
+
+
+
+
 
 
 
+//*************************************************************************************************
+//	Global Types
+//*************************************************************************************************
+
+typedef struct WireOp
+{
+	uint8_t command;
+	uint8_t data;
+} WIREOP;
+
 
 
 
@@ -122,6 +152,7 @@ class DS2482
 		uint8_t searchDone;
 		
 		void setConfig(uint8_t);
+		void setSpeed(uint8_t);
 		
 		#ifdef DS2482_800
 		uint8_t setChannel(uint8_t);
@@ -139,12 +170,37 @@ class DS2482
 		void romMatch(uint8_t*);
 		void romSkip(void);
 		void romSearch(uint8_t*, uint8_t);
+		void romAlarmSearch(uint8_t*, uint8_t);
+		
+		void romResume(void);
+		void romOverdriveSkip(void);
+		void romOverdriveMatch(uint8_t*);
+		
+		WireOp queue[DS2482_QUEUE_SIZE];
+		uint8_t queueTotal;
+		
+		void queueClear(void);
+		uint8_t queueAdd(uint8_t, uint8_t);
+		void queueConfig(uint8_t);
+		#ifdef DS2482_800
+		void queueChannel(uint8_t);
+		#endif
+		void queueReset(void);
+		void queueWrite(uint8_t);
+		uint8_t queueRead(void);
+		uint8_t queueReadBit(void);
+		void queueMatch(uint8_t*);
+		void queueSkip(void);
+		
+		void queueStart(void (*)(void));
+		uint8_t queuePoll(void);
 		
 		void init(uint8_t);
 		
 	private:
 		uint8_t _address;
 		uint8_t _status;
+		uint8_t _config;
 		
 		#ifdef DS2482_800
 		uint8_t _channel;
@@ -153,9 +209,21 @@ class DS2482
 		uint8_t search_rom[8];
 		uint8_t searchLast;
 		
+		uint8_t _queueNext;
+		uint8_t _queueState;
+		uint16_t _queueTimeout;
+		void (*_queueDone)(void);
+		
+		void _queueFinish(void);
+		
 		void _reset(void);
 		uint8_t _getRegister(uint8_t);
 		void _busy(uint8_t);
+		void _writeConfig(uint8_t);
+		#ifdef DS2482_800
+		void _selectChannel(uint8_t);
+		#endif
+		void _search(uint8_t*, uint8_t, uint8_t);
 		
 };
 
@@ -51,6 +51,9 @@
 #define ONE_WIRE_SKIP_ROM		0xCC
 #define ONE_WIRE_SEARCH_ROM		0xF0
 #define ONE_WIRE_ALARM_SEARCH	0xEC
+#define ONE_WIRE_RESUME		0xA5
+#define ONE_WIRE_OVERDRIVE_SKIP	0x3C
+#define ONE_WIRE_OVERDRIVE_MATCH	0x69
 
 
 
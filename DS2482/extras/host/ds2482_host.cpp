@@ -0,0 +1,504 @@
+/*
+	Host benchmarks for the DS2482 and DS18B20 libraries by Ian T Metcalf
+		builds DS2482.cpp and DS18B20.cpp against the bridge model in utility/DS2482_Emulator.c
+	
+	Each bench runs the libraries on a population of virtual sensors, checks the readings
+	against what the sensors see and prints the simulated bus time (i2c and 1-Wire).
+	Run with "make check" in this folder, it fails if a bench does.
+	
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+	
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+
+//*************************************************************************************************
+//	Libraries
+//*************************************************************************************************
+
+#include <DS2482.h>
+#include <DS18B20.h>
+
+#include <stdio.h>
+#include <string.h>
+
+
+
+
+//*************************************************************************************************
+//	Global Definitions
+//*************************************************************************************************
+
+// channel bit mask of parasite powered sensors in the polling bench
+#define BENCH_PARASITE		0x84
+
+// give up on a bench after this much simulated time (ms)
+#define BENCH_LIMIT			60000
+
+extern "C" void TIMER1_COMPA_vect(void);
+
+static uint8_t failed;
+
+
+
+
+//*************************************************************************************************
+//	Helper Functions
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Start over with an empty bus and eeprom
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void busReset(void)
+{
+	ds2482_emu_init(0);
+	ds2482_emu.timerIsr = TIMER1_COMPA_vect;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Add sensors to every channel, each with its own temperature
+//
+//	Input	perChannel: sensors on each channel
+//			parasite: channel bit mask of parasite powered sensors
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void addSensors(uint8_t perChannel, uint8_t parasite)
+{
+	uint8_t channel, count;
+	int index;
+	
+	for (channel = 0; channel < 8; channel++)
+	{
+		for (count = 0; count < perChannel; count++)
+		{
+			index = ds2482_emu_add_sensor(channel, 0x1000 + channel * 16 + count, (parasite >> channel) & 1);
+			ds2482_emu.device[index].temp = (20 + channel) * 16 + count;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Start the libraries and store every sensor found
+//
+//	Input	none
+//
+//	Output	sensors stored
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint8_t enrolSensors(void)
+{
+	Device sensor;
+	Scratch scratch;
+	
+	ds2482.init(0);
+	dsTemp.init();
+	dsTemp.resetSensors();
+	
+	while (dsTemp.findSensor(sensor, scratch))
+	{
+		dsTemp.storeSensor(dsTemp.totalSensors() + 1, sensor);
+	}
+	
+	return dsTemp.totalSensors();
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the temperature a virtual sensor sees
+//
+//	Input	&sensor: reference to device data
+//
+//	Output	temperature (1/16 C)
+//
+//-------------------------------------------------------------------------------------------------
+
+static int16_t sensorTemp(Device &sensor)
+{
+	uint8_t index;
+	
+	for (index = 0; index < ds2482_emu.devices; index++)
+	{
+		if (memcmp(ds2482_emu.device[index].rom, sensor.addr, 8) == 0)
+		{
+			return ds2482_emu.device[index].temp;
+		}
+	}
+	
+	return -1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the 1-Wire traffic so far
+//
+//	Input	none
+//
+//	Output	bytes (bits rounded down to bytes)
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint32_t wireBytes(void)
+{
+	return ds2482_emu.count.wireBytes + ds2482_emu.count.wireBits / 8;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Print the result of a bench
+//
+//	Input	*name: bench name
+//			wrong: wrong readings (0 passes)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void report(const char *name, uint32_t wrong)
+{
+	if (wrong || ds2482_emu.count.errors)
+	{
+		failed++;
+		printf("%-10s FAIL (%u wrong, %u bus errors)\n\n", name, wrong, ds2482_emu.count.errors);
+	}
+	else
+	{
+		printf("%-10s ok\n\n", name);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Run polling until every stored sensor has a reading in a finished round
+//
+//	Input	&longest: longest update() call (us)
+//			&inside: time inside update() (us)
+//
+//	Output	time taken (us)
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint32_t pollAll(uint32_t &longest, uint32_t &inside)
+{
+	Snapshot snap;
+	uint32_t start, call, took;
+	uint8_t num, missing, more;
+	
+	memset(&snap, 0, sizeof(snap));
+	
+	longest = 0;
+	inside = 0;
+	start = ds2482_emu.now;
+	missing = 1;
+	
+	dsTemp.isr_flags = (TEMP_C << ISR_FLAG_UNITS);
+	dsTemp.polling(1);
+	
+	while (missing && ds2482_emu.now - start < BENCH_LIMIT * 1000UL)
+	{
+		call = ds2482_emu.now;
+		more = dsTemp.update();
+		
+		took = ds2482_emu.now - call;
+		inside += took;
+		
+		if (took > longest)
+		{
+			longest = took;
+		}
+		
+		// the main loop would do other work until the next tick
+		if (!more)
+		{
+			ds2482_emu_run(1);
+		}
+		
+		if (dsTemp.snapshot(snap))
+		{
+			missing = 0;
+			
+			// a reading from before this run is missing too
+			for (num = 1; num <= dsTemp.totalSensors(); num++)
+			{
+				if (!SNAPSHOT_VALID(snap, num) || dsTemp.snapshotAge(snap, num) > (ds2482_emu.now - start) / 1000000UL)
+				{
+					missing = 1;
+				}
+			}
+		}
+	}
+	
+	dsTemp.polling(0);
+	
+	return ds2482_emu.now - start;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Count the stored sensors whose temps[] reading is not what they see
+//
+//	Input	none
+//
+//	Output	wrong readings
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint32_t checkTemps(void)
+{
+	Device sensor;
+	uint32_t wrong = 0;
+	uint8_t num;
+	
+	for (num = 1; num <= dsTemp.totalSensors(); num++)
+	{
+		dsTemp.loadSensor(num, sensor);
+		
+		if ((int16_t)dsTemp.temps[num] != sensorTemp(sensor))
+		{
+			wrong++;
+		}
+	}
+	
+	return wrong;
+}
+
+
+
+
+//*************************************************************************************************
+//	Benchmarks
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// One scratchpad read, blocking and through the onewire queue
+//
+//-------------------------------------------------------------------------------------------------
+
+static void benchQueue(void)
+{
+	Device sensor;
+	Scratch scratch;
+	uint32_t start, blocking, inside, call;
+	uint16_t polls;
+	uint8_t first, i, crc, wrong;
+	
+	busReset();
+	addSensors(1, 0);
+	enrolSensors();
+	
+	dsTemp.loadSensor(1, sensor);
+	dsTemp.startConversion(sensor);
+	dsTemp.conversionDelay(1, 3);
+	ds2482.error_flags = 0;
+	
+	start = ds2482_emu.now;
+	dsTemp.readScratchpad(sensor, scratch);
+	blocking = ds2482_emu.now - start;
+	
+	wrong = (ds2482.error_flags || scratch.temp[TEMP_C] != sensorTemp(sensor)) ? 1 : 0;
+	
+	ds2482.queueClear();
+	ds2482.queueMatch(sensor.addr);
+	ds2482.queueWrite(DS18B20_READ_SCRATCHPAD);
+	
+	first = ds2482.queueRead();
+	
+	for (i = 1; i < 9; i++)
+	{
+		ds2482.queueRead();
+	}
+	
+	ds2482.queueStart(0);
+	
+	polls = 0;
+	inside = 0;
+	start = ds2482_emu.now;
+	
+	do
+	{
+		// the main loop would do other work between polls
+		ds2482_emu_delay(200);
+		
+		call = ds2482_emu.now;
+		polls++;
+		
+		i = ds2482.queuePoll();
+		inside += ds2482_emu.now - call;
+	}
+	while (i);
+	
+	crc = 0;
+	
+	for (i = 0; i < 9; i++)
+	{
+		crc = _crc_ibutton_update(crc, ds2482.queue[first + i].data);
+	}
+	
+	if (ds2482.error_flags || crc || (int16_t)(ds2482.queue[first].data | (ds2482.queue[first + 1].data << 8)) != sensorTemp(sensor))
+	{
+		wrong++;
+	}
+	
+	printf("scratchpad read, blocking: %.1f ms in the call\n", blocking / 1000.0);
+	printf("scratchpad read, queued: %u polls, %.1f ms inside queuePoll of %.1f ms\n", polls, inside / 1000.0, (ds2482_emu.now - start) / 1000.0);
+	
+	report("queue", wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// The update() pump on 4 sensors per channel, two channels parasite powered
+//
+//-------------------------------------------------------------------------------------------------
+
+static void benchPolling(void)
+{
+	uint32_t took, longest, inside;
+	uint8_t total;
+	
+	busReset();
+	addSensors(4, BENCH_PARASITE);
+	total = enrolSensors();
+	
+	took = pollAll(longest, inside);
+	
+	printf("%u sensors polled in %u ms, longest update() %.2f ms, %u ms inside update()\n", total, took / 1000, longest / 1000.0, inside / 1000);
+	
+	report("polling", checkTemps());
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Alarm search sweep against reading every scratchpad, 3 of 32 sensors out of band
+//
+//-------------------------------------------------------------------------------------------------
+
+static void benchAlarm(void)
+{
+	Device sensor;
+	Scratch scratch;
+	uint32_t start, bytes, wrong;
+	uint8_t channel, index, num, found;
+	
+	busReset();
+	addSensors(4, 0x80);
+	
+	// alarm limits 10 to 30 C, kept by the sensor eeprom through enrolment
+	for (index = 0; index < ds2482_emu.devices; index++)
+	{
+		ds2482_emu.device[index].temp = 22 * 16;
+		ds2482_emu.device[index].scratch[2] = 30;
+		ds2482_emu.device[index].scratch[3] = 10;
+	}
+	
+	ds2482_emu.device[5].temp = 35 * 16;
+	ds2482_emu.device[17].temp = 5 * 16;
+	ds2482_emu.device[24].temp = 40 * 16;
+	
+	enrolSensors();
+	ds2482.error_flags = 0;
+	
+	for (channel = 0; channel < 8; channel++)
+	{
+		dsTemp.startConversion(channel);
+		dsTemp.conversionDelay(!(0x80 & (1 << channel)), 3);
+	}
+	
+	ds2482.error_flags = 0;
+	wrong = 0;
+	found = 0;
+	
+	start = ds2482_emu.now;
+	bytes = wireBytes();
+	
+	while ((num = dsTemp.alarmSensor(sensor, scratch)) && found < 32)
+	{
+		found++;
+		
+		if (scratch.temp[TEMP_C] != sensorTemp(sensor) || (sensorTemp(sensor) >= 10 * 16 && sensorTemp(sensor) <= 30 * 16))
+		{
+			wrong++;
+		}
+	}
+	
+	wrong += (found != 3 || ds2482.error_flags) ? 1 : 0;
+	
+	printf("alarm sweep: %u in alarm, %u ms, %u wire bytes\n", found, (ds2482_emu.now - start) / 1000, wireBytes() - bytes);
+	
+	start = ds2482_emu.now;
+	bytes = wireBytes();
+	
+	for (num = 1; num <= dsTemp.totalSensors(); num++)
+	{
+		dsTemp.loadSensor(num, sensor);
+		dsTemp.readScratchpad(sensor, scratch);
+	}
+	
+	printf("read every scratchpad: %u ms, %u wire bytes\n", (ds2482_emu.now - start) / 1000, wireBytes() - bytes);
+	
+	report("alarm", wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// More sensors on the bus than DS18B20_MAX_SENSORS, all stored ones read back
+//
+//-------------------------------------------------------------------------------------------------
+
+static void benchCapacity(void)
+{
+	uint32_t took, longest, inside, wrong;
+	uint8_t total;
+	
+	busReset();
+	addSensors(9, 0);
+	total = enrolSensors();
+	
+	// the store fills up at the capacity and says so
+	wrong = (total != ((DS18B20_MAX_SENSORS < 72) ? DS18B20_MAX_SENSORS : 72)) ? 1 : 0;
+	
+	if (DS18B20_MAX_SENSORS < 72 && !(ds2482.error_flags & (1 << ERROR_EEPROM_FULL)))
+	{
+		wrong++;
+	}
+	
+	ds2482.error_flags = 0;
+	
+	took = pollAll(longest, inside);
+	wrong += checkTemps();
+	
+	printf("72 sensors on the bus, %u stored (capacity %u), polled in %u ms\n", total, DS18B20_MAX_SENSORS, took / 1000);
+	
+	report("capacity", wrong);
+}
+
+
+
+
+//*************************************************************************************************
+//	Main
+//*************************************************************************************************
+
+int main(void)
+{
+	benchQueue();
+	benchPolling();
+	benchAlarm();
+	benchCapacity();
+	
+	return (failed) ? 1 : 0;
+}
@@ -0,0 +1,850 @@
+/*
+	Software model of the DS2482-800 onewire bridge by Ian T Metcalf
+		used to build and run the DS2482 and DS18B20 libraries on a host machine
+
+	See DS2482_Emulator.h for what is modeled.
+
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+#ifdef DS2482_EMULATOR
+
+/****************************************************************************
+  Libraries
+****************************************************************************/
+
+#include <string.h>
+#include "DS2482_Emulator.h"
+#include "../DS2482_Commands.h"
+
+/****************************************************************************
+  Local definitions
+****************************************************************************/
+
+// bus state of a channel
+#define WIRE_IDLE			0
+#define WIRE_ROM			1
+#define WIRE_READ_ROM		2
+#define WIRE_MATCH			3
+#define WIRE_SEARCH			4
+#define WIRE_FUNCTION		5
+#define WIRE_READ_SCRATCH	6
+#define WIRE_WRITE_SCRATCH	7
+#define WIRE_READ_POWER		8
+#define WIRE_BUSY			9
+
+// DS18B20
+#define SENSOR_FAMILY			0x28
+#define SENSOR_CONVERT			0x44
+#define SENSOR_WRITE_SCRATCH	0x4E
+#define SENSOR_READ_SCRATCH		0xBE
+#define SENSOR_COPY_SCRATCH		0x48
+#define SENSOR_RECALL			0xB8
+#define SENSOR_READ_POWER		0xB4
+
+#define SENSOR_IDLE			0
+#define SENSOR_CONVERTING	1
+#define SENSOR_COPYING		2
+
+/****************************************************************************
+  Global variable
+****************************************************************************/
+
+DS2482_Emulator ds2482_emu;
+
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t OCR1A, OCR1B;
+
+/****************************************************************************
+  Sensor model
+****************************************************************************/
+
+static uint8_t crc8(const uint8_t *data, uint8_t size)
+{
+	uint8_t crc = 0;
+
+	while (size--)
+	{
+		crc = _crc_ibutton_update(crc, *data++);
+	}
+
+	return crc;
+}
+
+// Finish a conversion or eeprom copy once its time has passed
+static void sensorUpdate(DS2482_EmuDevice *dev)
+{
+	if (dev->busy == SENSOR_IDLE || ds2482_emu.now < dev->doneAt)
+	{
+		return;
+	}
+
+	if (dev->busy == SENSOR_CONVERTING)
+	{
+		int16_t temp = DS2482_EMU_POWER_ON_TEMP;
+
+		if (!dev->starved)
+		{
+			uint8_t resolution = (dev->scratch[4] >> 5) & 0x03;
+			temp = dev->temp & ~((1 << (3 - resolution)) - 1);
+		}
+
+		dev->scratch[0] = temp & 0xFF;
+		dev->scratch[1] = (temp >> 8) & 0xFF;
+		dev->scratch[8] = crc8(dev->scratch, 8);
+	}
+	else
+	{
+		memcpy(dev->eeprom, &dev->scratch[2], 3);
+	}
+
+	dev->busy = SENSOR_IDLE;
+}
+
+// A parasite sensor that is still converting when the strong pullup ends loses its reading
+static void pullupEnd(uint8_t channel)
+{
+	uint8_t i;
+
+	if (!ds2482_emu.wire[channel].pullup)
+	{
+		return;
+	}
+
+	ds2482_emu.wire[channel].pullup = 0;
+
+	for (i = 0; i < ds2482_emu.devices; i++)
+	{
+		DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+		if (dev->channel == channel && dev->parasite)
+		{
+			sensorUpdate(dev);
+
+			if (dev->busy != SENSOR_IDLE)
+			{
+				dev->starved = 1;
+			}
+		}
+	}
+}
+
+// Start a function command on the selected sensors
+static void sensorFunction(DS2482_EmuChannel *wire, uint8_t command)
+{
+	uint8_t i, spu;
+
+	spu = (ds2482_emu.config & DS2482_CONFIG_SPU) ? 1 : 0;
+	wire->mode = WIRE_IDLE;
+	wire->index = 0;
+
+	for (i = 0; i < ds2482_emu.devices; i++)
+	{
+		DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+		if (!dev->active)
+		{
+			continue;
+		}
+
+		switch (command)
+		{
+			case SENSOR_CONVERT:
+				dev->busy = SENSOR_CONVERTING;
+				dev->starved = (dev->parasite && !spu) ? 1 : 0;
+				dev->doneAt = ds2482_emu.now + (DS2482_EMU_CONVERT_US << ((dev->scratch[4] >> 5) & 0x03));
+				wire->mode = WIRE_BUSY;
+				break;
+
+			case SENSOR_COPY_SCRATCH:
+				dev->busy = SENSOR_COPYING;
+				dev->doneAt = ds2482_emu.now + DS2482_EMU_COPY_US;
+				wire->mode = WIRE_BUSY;
+				break;
+
+			case SENSOR_RECALL:
+				memcpy(&dev->scratch[2], dev->eeprom, 3);
+				dev->scratch[8] = crc8(dev->scratch, 8);
+				wire->mode = WIRE_BUSY;
+				break;
+
+			case SENSOR_READ_SCRATCH:
+				wire->mode = WIRE_READ_SCRATCH;
+
+				if (dev->crcFaults)
+				{
+					dev->crcFaults--;
+					dev->scratch[8] ^= 0x5A;
+				}
+				else
+				{
+					dev->scratch[8] = crc8(dev->scratch, 8);
+				}
+				break;
+
+			case SENSOR_WRITE_SCRATCH:
+				wire->mode = WIRE_WRITE_SCRATCH;
+				break;
+
+			case SENSOR_READ_POWER:
+				wire->mode = WIRE_READ_POWER;
+				break;
+		}
+	}
+}
+
+// A rom command byte after reset
+static void romCommand(DS2482_EmuChannel *wire, uint8_t command)
+{
+	uint8_t i;
+
+	wire->index = 0;
+
+	switch (command)
+	{
+		case ONE_WIRE_READ_ROM:
+			wire->mode = WIRE_READ_ROM;
+			break;
+
+		case ONE_WIRE_MATCH_ROM:
+			wire->mode = WIRE_MATCH;
+			break;
+
+		case ONE_WIRE_SKIP_ROM:
+			wire->mode = WIRE_FUNCTION;
+			break;
+
+		case ONE_WIRE_SEARCH_ROM:
+			wire->mode = WIRE_SEARCH;
+			break;
+
+		case ONE_WIRE_ALARM_SEARCH:
+			wire->mode = WIRE_SEARCH;
+
+			// alarm when the integer temperature is at or past a limit
+			for (i = 0; i < ds2482_emu.devices; i++)
+			{
+				DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+				int8_t whole = (int8_t)((dev->scratch[1] << 4) | (dev->scratch[0] >> 4));
+
+				if (dev->active && whole < (int8_t)dev->scratch[2] && whole > (int8_t)dev->scratch[3])
+				{
+					dev->active = 0;
+				}
+			}
+			break;
+
+		default:
+			wire->mode = WIRE_IDLE;
+			break;
+	}
+}
+
+// Wired and of the selected sensors driving a bit
+static uint8_t busOutput(DS2482_EmuChannel *wire, uint8_t phase)
+{
+	uint8_t i, out = 1;
+
+	for (i = 0; i < ds2482_emu.devices; i++)
+	{
+		DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+		uint8_t bit = 1;
+
+		if (!dev->active)
+		{
+			continue;
+		}
+
+		sensorUpdate(dev);
+
+		switch (wire->mode)
+		{
+			case WIRE_READ_ROM:
+				bit = (dev->rom[wire->index >> 3] >> (wire->index & 7)) & 1;
+				break;
+
+			case WIRE_SEARCH:
+				bit = (dev->rom[wire->index >> 3] >> (wire->index & 7)) & 1;
+				bit = (phase) ? !bit : bit;
+				break;
+
+			case WIRE_READ_SCRATCH:
+				bit = (wire->index < 72) ? (dev->scratch[wire->index >> 3] >> (wire->index & 7)) & 1 : 1;
+				break;
+
+			case WIRE_READ_POWER:
+				bit = !dev->parasite;
+				break;
+
+			case WIRE_BUSY:
+				bit = (dev->busy != SENSOR_IDLE && !dev->parasite) ? 0 : 1;
+				break;
+		}
+
+		out &= bit;
+	}
+
+	return out;
+}
+
+// One time slot on the selected channel, returns the level read back
+static uint8_t wireBit(uint8_t bit)
+{
+	DS2482_EmuChannel *wire = &ds2482_emu.wire[ds2482_emu.channel];
+	uint8_t i, out;
+
+	ds2482_emu.count.wireBits++;
+
+	if (wire->shorted)
+	{
+		return 0;
+	}
+
+	switch (wire->mode)
+	{
+		case WIRE_ROM:
+		case WIRE_FUNCTION:
+		case WIRE_WRITE_SCRATCH:
+			wire->data |= (bit & 1) << wire->bitCount;
+
+			if (++wire->bitCount == 8)
+			{
+				uint8_t data = wire->data;
+
+				wire->bitCount = 0;
+				wire->data = 0;
+
+				if (wire->mode == WIRE_ROM)
+				{
+					romCommand(wire, data);
+				}
+				else if (wire->mode == WIRE_FUNCTION)
+				{
+					sensorFunction(wire, data);
+				}
+				else if (wire->index < 3)
+				{
+					for (i = 0; i < ds2482_emu.devices; i++)
+					{
+						DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+						if (dev->active)
+						{
+							dev->scratch[2 + wire->index] = (wire->index == 2) ? ((data & 0x60) | 0x1F) : data;
+							dev->scratch[8] = crc8(dev->scratch, 8);
+						}
+					}
+
+					wire->index++;
+				}
+			}
+			return bit;
+
+		case WIRE_MATCH:
+			for (i = 0; i < ds2482_emu.devices; i++)
+			{
+				DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+				if (dev->active && ((dev->rom[wire->index >> 3] >> (wire->index & 7)) & 1) != (bit & 1))
+				{
+					dev->active = 0;
+				}
+			}
+
+			if (++wire->index == 64)
+			{
+				wire->mode = WIRE_FUNCTION;
+				wire->index = 0;
+			}
+			return bit;
+
+		case WIRE_SEARCH:
+			// id bit, complement bit, then the direction written by the master
+			if (wire->bitCount < 2)
+			{
+				out = busOutput(wire, wire->bitCount);
+				wire->bitCount++;
+				return bit & out;
+			}
+
+			for (i = 0; i < ds2482_emu.devices; i++)
+			{
+				DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+				if (dev->active && ((dev->rom[wire->index >> 3] >> (wire->index & 7)) & 1) != (bit & 1))
+				{
+					dev->active = 0;
+				}
+			}
+
+			wire->bitCount = 0;
+
+			if (++wire->index == 64)
+			{
+				wire->mode = WIRE_FUNCTION;
+				wire->index = 0;
+			}
+			return bit;
+
+		case WIRE_READ_ROM:
+		case WIRE_READ_SCRATCH:
+			out = busOutput(wire, 0);
+
+			if (++wire->index == ((wire->mode == WIRE_READ_ROM) ? 64 : 255))
+			{
+				wire->mode = (wire->mode == WIRE_READ_ROM) ? WIRE_FUNCTION : WIRE_IDLE;
+				wire->index = 0;
+			}
+			return bit & out;
+
+		case WIRE_READ_POWER:
+		case WIRE_BUSY:
+			return bit & busOutput(wire, 0);
+	}
+
+	return bit;
+}
+
+/****************************************************************************
+  Bridge commands
+****************************************************************************/
+
+static void wireReset(void)
+{
+	DS2482_EmuChannel *wire = &ds2482_emu.wire[ds2482_emu.channel];
+	uint8_t i, present = 0;
+
+	ds2482_emu.count.wireResets++;
+	ds2482_emu.status &= ~(DS2482_STATUS_PPD | DS2482_STATUS_SD);
+
+	wire->mode = WIRE_ROM;
+	wire->bitCount = 0;
+	wire->data = 0;
+	wire->index = 0;
+
+	for (i = 0; i < ds2482_emu.devices; i++)
+	{
+		DS2482_EmuDevice *dev = &ds2482_emu.device[i];
+
+		dev->active = (dev->channel == ds2482_emu.channel && dev->present && !(ds2482_emu.config & DS2482_CONFIG_WS)) ? 1 : 0;
+		present |= dev->active;
+	}
+
+	if (wire->shorted)
+	{
+		ds2482_emu.status |= DS2482_STATUS_SD;
+	}
+	else if (present)
+	{
+		ds2482_emu.status |= DS2482_STATUS_PPD;
+	}
+}
+
+static void wireTriplet(uint8_t dir)
+{
+	uint8_t sbr, tsb;
+
+	sbr = wireBit(1);
+	tsb = wireBit(1);
+
+	if (sbr != tsb)
+	{
+		dir = sbr;
+	}
+	else if (sbr)
+	{
+		dir = 1;
+	}
+
+	wireBit(dir);
+
+	ds2482_emu.status &= ~(DS2482_STATUS_SBR | DS2482_STATUS_TSB | DS2482_STATUS_DIR);
+	ds2482_emu.status |= (sbr ? DS2482_STATUS_SBR : 0) | (tsb ? DS2482_STATUS_TSB : 0) | (dir ? DS2482_STATUS_DIR : 0);
+}
+
+static uint8_t channelCode(uint8_t channel, uint8_t read)
+{
+	static const uint8_t writeCodes[8] = {0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87};
+	static const uint8_t readCodes[8] = {0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87};
+
+	return (read) ? readCodes[channel] : writeCodes[channel];
+}
+
+// Command with no parameter (or the parameter byte when one is expected)
+static void execute(uint8_t command, uint8_t param)
+{
+	uint8_t i, spu = 0;
+	uint32_t slot = (ds2482_emu.config & DS2482_CONFIG_WS) ? DS2482_EMU_OD_SLOT_US : DS2482_EMU_SLOT_US;
+
+	// 1-Wire commands are refused while the line is busy
+	if (command == DS2482_ONE_WIRE_RESET || command == DS2482_ONE_WIRE_WRITE_BYTE || command == DS2482_ONE_WIRE_READ_BYTE ||
+		command == DS2482_ONE_WIRE_SINGLE_BIT || command == DS2482_ONE_WIRE_TRIPLET)
+	{
+		if (ds2482_emu.now < ds2482_emu.busyUntil)
+		{
+			ds2482_emu.count.errors++;
+			return;
+		}
+
+		spu = (ds2482_emu.config & DS2482_CONFIG_SPU) ? 1 : 0;
+		pullupEnd(ds2482_emu.channel);
+		ds2482_emu.pointer = DS2482_STATUS_REG;
+	}
+
+	switch (command)
+	{
+		case DS2482_DEVICE_RESET:
+			pullupEnd(ds2482_emu.channel);
+			ds2482_emu.status = DS2482_STATUS_RST | DS2482_STATUS_LL;
+			ds2482_emu.config = 0;
+			ds2482_emu.channel = 0;
+			ds2482_emu.busyUntil = 0;
+			ds2482_emu.pointer = DS2482_STATUS_REG;
+			return;
+
+		case DS2482_SET_POINTER:
+			ds2482_emu.pointer = param;
+			return;
+
+		case DS2482_WRITE_CONFIG:
+			if ((param >> 4) != ((~param) & 0x0F))
+			{
+				ds2482_emu.count.errors++;
+				return;
+			}
+
+			if (!(param & DS2482_CONFIG_SPU))
+			{
+				pullupEnd(ds2482_emu.channel);
+			}
+
+			ds2482_emu.config = param & 0x0F;
+			ds2482_emu.status &= ~DS2482_STATUS_RST;
+			ds2482_emu.pointer = DS2482_CONFIG_REG;
+			return;
+
+		case DS2482_SELECT_CHANNEL:
+			for (i = 0; i < DS2482_EMU_CHANNELS; i++)
+			{
+				if (channelCode(i, 0) == param)
+				{
+					pullupEnd(ds2482_emu.channel);
+					ds2482_emu.channel = i;
+					ds2482_emu.pointer = DS2482_CHANNEL_REG;
+					return;
+				}
+			}
+
+			ds2482_emu.count.errors++;
+			return;
+
+		case DS2482_ONE_WIRE_RESET:
+			wireReset();
+			ds2482_emu.busyUntil = ds2482_emu.now + ((ds2482_emu.config & DS2482_CONFIG_WS) ? DS2482_EMU_OD_RESET_US : DS2482_EMU_RESET_US);
+			return;
+
+		case DS2482_ONE_WIRE_WRITE_BYTE:
+			ds2482_emu.count.wireBytes++;
+
+			for (i = 0; i < 8; i++)
+			{
+				wireBit((param >> i) & 1);
+			}
+
+			ds2482_emu.busyUntil = ds2482_emu.now + 8 * slot;
+			break;
+
+		case DS2482_ONE_WIRE_READ_BYTE:
+			ds2482_emu.count.wireBytes++;
+			ds2482_emu.dataReg = 0;
+
+			for (i = 0; i < 8; i++)
+			{
+				ds2482_emu.dataReg |= wireBit(1) << i;
+			}
+
+			ds2482_emu.busyUntil = ds2482_emu.now + 8 * slot;
+			return;
+
+		case DS2482_ONE_WIRE_SINGLE_BIT:
+			ds2482_emu.status &= ~DS2482_STATUS_SBR;
+			ds2482_emu.status |= wireBit((param & 0x80) ? 1 : 0) ? DS2482_STATUS_SBR : 0;
+			ds2482_emu.busyUntil = ds2482_emu.now + slot;
+			break;
+
+		case DS2482_ONE_WIRE_TRIPLET:
+			wireTriplet((param & 0x80) ? 1 : 0);
+			ds2482_emu.busyUntil = ds2482_emu.now + 3 * slot;
+			break;
+
+		default:
+			ds2482_emu.count.errors++;
+			return;
+	}
+
+	// strong pullup after a write byte, bit or triplet when SPU was set
+	if (spu)
+	{
+		ds2482_emu.wire[ds2482_emu.channel].pullup = 1;
+		ds2482_emu.config &= ~DS2482_CONFIG_SPU;
+	}
+}
+
+static uint8_t readRegister(void)
+{
+	switch (ds2482_emu.pointer)
+	{
+		case DS2482_STATUS_REG:
+			ds2482_emu.status &= ~DS2482_STATUS_BUSY;
+
+			if (ds2482_emu.now < ds2482_emu.busyUntil)
+			{
+				ds2482_emu.status |= DS2482_STATUS_BUSY;
+			}
+
+			return ds2482_emu.status;
+
+		case DS2482_DATA_REG:
+			return ds2482_emu.dataReg;
+
+		case DS2482_CHANNEL_REG:
+			return channelCode(ds2482_emu.channel, 1);
+
+		case DS2482_CONFIG_REG:
+			return ds2482_emu.config;
+	}
+
+	ds2482_emu.count.errors++;
+	return 0xFF;
+}
+
+/****************************************************************************
+  i2cmaster interface
+****************************************************************************/
+
+void i2c_init(void)
+{
+}
+
+unsigned char i2c_start(unsigned char addr)
+{
+	ds2482_emu.count.i2cStarts++;
+	ds2482_emu.count.i2cBytes++;
+	ds2482_emu_delay(DS2482_EMU_I2C_EDGE_US + DS2482_EMU_I2C_BYTE_US);
+
+	if ((addr & ~I2C_READ) != ds2482_emu.address)
+	{
+		return 1;
+	}
+
+	ds2482_emu.i2cRead = addr & I2C_READ;
+	ds2482_emu.i2cCount = 0;
+
+	return 0;
+}
+
+unsigned char i2c_rep_start(unsigned char addr)
+{
+	return i2c_start(addr);
+}
+
+void i2c_start_wait(unsigned char addr)
+{
+	while (i2c_start(addr))
+	{
+		ds2482_emu.count.errors++;
+	}
+}
+
+void i2c_stop(void)
+{
+	ds2482_emu_delay(DS2482_EMU_I2C_EDGE_US);
+}
+
+unsigned char i2c_write(unsigned char data)
+{
+	ds2482_emu.count.i2cBytes++;
+	ds2482_emu_delay(DS2482_EMU_I2C_BYTE_US);
+
+	if (ds2482_emu.i2cRead)
+	{
+		ds2482_emu.count.errors++;
+		return 1;
+	}
+
+	if (ds2482_emu.i2cCount++ == 0)
+	{
+		ds2482_emu.i2cCommand = data;
+
+		// commands without a parameter run on the command byte
+		if (data == DS2482_DEVICE_RESET || data == DS2482_ONE_WIRE_RESET || data == DS2482_ONE_WIRE_READ_BYTE)
+		{
+			execute(data, 0);
+		}
+	}
+	else
+	{
+		execute(ds2482_emu.i2cCommand, data);
+	}
+
+	return 0;
+}
+
+unsigned char i2c_readAck(void)
+{
+	ds2482_emu.count.i2cBytes++;
+	ds2482_emu_delay(DS2482_EMU_I2C_BYTE_US);
+
+	return readRegister();
+}
+
+unsigned char i2c_readNak(void)
+{
+	return i2c_readAck();
+}
+
+/****************************************************************************
+  eeprom
+****************************************************************************/
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	return ds2482_emu.eeprom[(size_t)addr & E2END];
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t data)
+{
+	ds2482_emu.count.eepromWrites++;
+	ds2482_emu.eeprom[(size_t)addr & E2END] = data;
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+	{
+		((uint8_t*)dst)[i] = eeprom_read_byte((const uint8_t*)src + i);
+	}
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+	{
+		eeprom_write_byte((uint8_t*)dst + i, ((const uint8_t*)src)[i]);
+	}
+}
+
+/****************************************************************************
+  Model control
+****************************************************************************/
+
+// Power up the bridge at an i2c address (0-3, as passed to DS2482::init) with no sensors
+void ds2482_emu_init(uint8_t address)
+{
+	memset(&ds2482_emu, 0, sizeof(ds2482_emu));
+	memset(ds2482_emu.eeprom, 0xFF, sizeof(ds2482_emu.eeprom));
+
+	ds2482_emu.address = (0x18 | (address & 0x03)) << 1;
+	ds2482_emu.status = DS2482_STATUS_RST | DS2482_STATUS_LL;
+	ds2482_emu.pointer = DS2482_STATUS_REG;
+}
+
+// Add a DS18B20 on a channel (rom built from the serial number), returns its index or -1
+int ds2482_emu_add_sensor(uint8_t channel, uint32_t serial, uint8_t parasite)
+{
+	DS2482_EmuDevice *dev;
+	uint8_t i;
+
+	if (ds2482_emu.devices >= DS2482_EMU_MAX_DEVICES || channel >= DS2482_EMU_CHANNELS)
+	{
+		return -1;
+	}
+
+	dev = &ds2482_emu.device[ds2482_emu.devices];
+	memset(dev, 0, sizeof(DS2482_EmuDevice));
+
+	dev->rom[0] = SENSOR_FAMILY;
+
+	for (i = 1; i < 7; i++)
+	{
+		dev->rom[i] = (i < 5) ? (serial >> ((i - 1) * 8)) & 0xFF : 0;
+	}
+
+	dev->rom[7] = crc8(dev->rom, 7);
+
+	dev->channel = channel;
+	dev->parasite = parasite;
+	dev->present = 1;
+	dev->temp = 25 << 4;
+
+	// power on scratchpad, 12 bit resolution
+	dev->eeprom[0] = 75;
+	dev->eeprom[1] = 70;
+	dev->eeprom[2] = 0x7F;
+
+	dev->scratch[0] = DS2482_EMU_POWER_ON_TEMP & 0xFF;
+	dev->scratch[1] = DS2482_EMU_POWER_ON_TEMP >> 8;
+	memcpy(&dev->scratch[2], dev->eeprom, 3);
+	dev->scratch[5] = 0xFF;
+	dev->scratch[6] = 0x0C;
+	dev->scratch[7] = 0x10;
+	dev->scratch[8] = crc8(dev->scratch, 8);
+
+	return ds2482_emu.devices++;
+}
+
+// Move simulated time forward, calling the Timer1 compare A handler when the timer is clocked and enabled
+void ds2482_emu_delay(uint32_t us)
+{
+	while (us)
+	{
+		uint32_t period;
+
+		if (!(TCCR1B & 0x07) || !(TIMSK1 & (1 << OCIE1A)) || !ds2482_emu.timerIsr)
+		{
+			ds2482_emu.now += us;
+			return;
+		}
+
+		// only the :1024 prescaler is used by the libraries
+		period = (uint32_t)(((uint64_t)(OCR1A + 1) * 1024 * 1000000) / F_CPU);
+
+		if (ds2482_emu.timerLeft == 0 || ds2482_emu.timerLeft > period)
+		{
+			ds2482_emu.timerLeft = period;
+		}
+
+		if (us < ds2482_emu.timerLeft)
+		{
+			ds2482_emu.timerLeft -= us;
+			ds2482_emu.now += us;
+			return;
+		}
+
+		us -= ds2482_emu.timerLeft;
+		ds2482_emu.now += ds2482_emu.timerLeft;
+		ds2482_emu.timerLeft = period;
+
+		ds2482_emu.timerIsr();
+	}
+}
+
+// Run for a while with the bus idle
+void ds2482_emu_run(uint32_t ms)
+{
+	ds2482_emu_delay(ms * 1000);
+}
+
+void ds2482_emu_clear_counters(void)
+{
+	memset(&ds2482_emu.count, 0, sizeof(DS2482_Counters));
+}
+
+#endif // DS2482_EMULATOR
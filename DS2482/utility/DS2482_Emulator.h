@@ -0,0 +1,228 @@
+/*
+	Software model of the DS2482-800 onewire bridge by Ian T Metcalf
+		used to build and run the DS2482 and DS18B20 libraries on a host machine
+
+	Define DS2482_EMULATOR when compiling DS2482.cpp, DS18B20.cpp (and this file) on the host
+	and the i2cmaster functions talk to this model instead of the avr twi hardware.
+
+	Modeled:
+		device reset, read pointer, configuration (APU, SPU, 1WS) and channel select
+		1-Wire reset, byte, bit and triplet commands with standard speed busy times
+		a population of DS18B20 sensors per channel with rom ids, scratchpads, eeprom,
+		conversion time per resolution and parasite power (needs the strong pullup)
+	overdrive timing; the sensors are standard speed only, so none answer an overdrive reset
+		and resume / overdrive rom commands deselect them like any unknown command
+		faults: shorted channel, missing sensor and corrupted scratchpad crc
+
+	Time is simulated: i2c transfers and the delay functions move the clock forward,
+	so the cost of a library call can be measured in bus time as well as in transfers.
+
+	Also stands in for the avr eeprom and Timer1 so the DS18B20 polling tick can run.
+
+	extras/host builds both libraries against this model and runs the queue, polling,
+	alarm sweep and capacity benchmarks (make check).
+
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+#ifndef DS2482_EMULATOR_H
+#define DS2482_EMULATOR_H
+
+#ifdef DS2482_EMULATOR
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/****************************************************************************
+  Host replacements for the avr headers used by the libraries
+****************************************************************************/
+
+#ifndef F_CPU
+#define F_CPU	16000000UL
+#endif
+
+#define _delay_us(us)		ds2482_emu_delay((uint32_t)(us))
+#define _delay_ms(ms)		ds2482_emu_delay((uint32_t)(ms) * 1000)
+
+static inline uint8_t _crc_ibutton_update(uint8_t crc, uint8_t data)
+{
+	uint8_t i;
+
+	crc = crc ^ data;
+
+	for (i = 0; i < 8; i++)
+	{
+		crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+	}
+
+	return crc;
+}
+
+// i2cmaster
+#define I2C_READ	1
+#define I2C_WRITE	0
+
+extern void i2c_init(void);
+extern void i2c_stop(void);
+extern unsigned char i2c_start(unsigned char addr);
+extern unsigned char i2c_rep_start(unsigned char addr);
+extern void i2c_start_wait(unsigned char addr);
+extern unsigned char i2c_write(unsigned char data);
+extern unsigned char i2c_readAck(void);
+extern unsigned char i2c_readNak(void);
+
+#define i2c_read(ack)	((ack) ? i2c_readAck() : i2c_readNak())
+
+// eeprom and ram (atmega644p size)
+#ifndef E2END
+#define E2END	0x7FF
+#endif
+
+#ifndef RAMEND
+#define RAMEND	0x10FF
+#endif
+
+extern uint8_t eeprom_read_byte(const uint8_t *addr);
+extern void eeprom_write_byte(uint8_t *addr, uint8_t data);
+extern void eeprom_read_block(void *dst, const void *src, size_t size);
+extern void eeprom_write_block(const void *src, void *dst, size_t size);
+
+// interrupts and Timer1 (the handler runs as simulated time moves)
+#ifdef __cplusplus
+#define ISR(vector)		extern "C" void vector(void)
+#else
+#define ISR(vector)		void vector(void)
+#endif
+
+#define sei()
+#define cli()
+
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint16_t OCR1A, OCR1B;
+
+#define CS10	0
+#define WGM10	0
+#define WGM12	3
+#define OCIE1A	1
+#define OCIE1B	2
+#define OCF1A	1
+#define OCF1B	2
+
+/****************************************************************************
+  Bridge and bus model
+****************************************************************************/
+
+#define DS2482_EMU_CHANNELS			8
+#define DS2482_EMU_MAX_DEVICES		128
+
+// bus time in microseconds (standard speed)
+#define DS2482_EMU_I2C_BYTE_US		90
+#define DS2482_EMU_I2C_EDGE_US		10
+#define DS2482_EMU_RESET_US			1148
+#define DS2482_EMU_SLOT_US			70
+#define DS2482_EMU_OD_RESET_US		146			// overdrive (1WS set)
+#define DS2482_EMU_OD_SLOT_US		10
+#define DS2482_EMU_COPY_US			10000
+
+// conversion time for 9 bit resolution (doubles for each added bit)
+#define DS2482_EMU_CONVERT_US		93750
+
+// power on temperature register (85 C), also left by a conversion that lost power
+#define DS2482_EMU_POWER_ON_TEMP	0x0550
+
+typedef struct
+{
+	uint32_t i2cStarts;
+	uint32_t i2cBytes;
+	uint32_t wireResets;
+	uint32_t wireBytes;
+	uint32_t wireBits;
+	uint32_t eepromWrites;
+	uint32_t errors;
+}
+DS2482_Counters;
+
+typedef struct
+{
+	uint8_t rom[8];
+	uint8_t channel;
+	uint8_t parasite;
+	uint8_t present;
+
+	int16_t temp;			// temperature the sensor sees (1/16 C)
+	uint8_t scratch[9];
+	uint8_t eeprom[3];		// alarm high, alarm low, config
+
+	uint8_t busy;
+	uint8_t starved;
+	uint32_t doneAt;
+
+	uint8_t active;			// still selected by the last rom command
+	uint8_t crcFaults;		// corrupt the crc of this many scratchpad reads
+}
+DS2482_EmuDevice;
+
+typedef struct
+{
+	uint8_t shorted;
+	uint8_t pullup;
+
+	uint8_t mode;
+	uint8_t bitCount;
+	uint8_t data;
+	uint8_t index;
+}
+DS2482_EmuChannel;
+
+typedef struct
+{
+	uint32_t now;
+
+	// bridge
+	uint8_t address;
+	uint8_t status;
+	uint8_t config;
+	uint8_t channel;
+	uint8_t dataReg;
+	uint8_t pointer;
+	uint32_t busyUntil;
+
+	// i2c transfer in progress
+	uint8_t i2cRead;
+	uint8_t i2cCommand;
+	uint8_t i2cCount;
+
+	DS2482_EmuChannel wire[DS2482_EMU_CHANNELS];
+	DS2482_EmuDevice device[DS2482_EMU_MAX_DEVICES];
+	uint8_t devices;
+
+	uint8_t eeprom[E2END + 1];
+
+	// Timer1 compare A interrupt handler and the time left to the next tick
+	void (*timerIsr)(void);
+	uint32_t timerLeft;
+
+	DS2482_Counters count;
+}
+DS2482_Emulator;
+
+extern DS2482_Emulator ds2482_emu;
+
+/****************************************************************************
+  Function definitions
+****************************************************************************/
+
+extern void ds2482_emu_init(uint8_t address);
+extern int ds2482_emu_add_sensor(uint8_t channel, uint32_t serial, uint8_t parasite);
+
+extern void ds2482_emu_delay(uint32_t us);
+extern void ds2482_emu_run(uint32_t ms);
+
+extern void ds2482_emu_clear_counters(void);
+
+#endif // DS2482_EMULATOR
+
+#endif // DS2482_EMULATOR_H
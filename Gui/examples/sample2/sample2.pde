@@ -45,6 +45,8 @@ Element move_scheme[] =
   {GUI_ARROW, 28, 0, NULL}
 };
 
+Snapshot temps;
+
 char strBuffer[32];
 char *strRes[] =
 {
@@ -143,6 +145,7 @@ void loop()
     
     if (press > 0 && press < 4)
     {
+      LCD.beginFrame();
       LCD.clearText();
       LCD.clearGraph();
       
@@ -151,24 +154,29 @@ void loop()
         case 1:
           dsTemp.polling(1);
           tempDraw();
+          LCD.endFrame();
           tempScheme();
           dsTemp.polling(0);
           break;
           
         case 2:
           relayDraw();
+          LCD.endFrame();
           relayScheme();
           break;
           
         case 3:
           moveDraw();
+          LCD.endFrame();
           moveScheme();
           break;
       }
       
+      LCD.beginFrame();
       LCD.clearText();
       LCD.clearGraph();
       homeDraw();
+      LCD.endFrame();
     }
     else if (press == 4)
     {
@@ -240,17 +248,23 @@ void tempScheme(void)
       }
     }
     
-    if (dsTemp.isr_flags & (1 << ISR_FLAG_NEW_TEMPS))
+    // bus work for the polling tick
+    dsTemp.update();
+    
+    if (dsTemp.snapshot(temps))
     {
-      dsTemp.isr_flags &= ~(1 << ISR_FLAG_NEW_TEMPS);
-      
       for (count = 1; count <= total; count++)
       {
         uint16_t temp, frac;
         
-        cli();
-        temp = dsTemp.temps[count];
-        sei();
+        if (!SNAPSHOT_VALID(temps, count))
+        {
+          LCD.textTo(24, 2 + count);
+          LCD.text("--        ");
+          continue;
+        }
+        
+        temp = temps.temps[count];
         
         LCD.textTo(24, 2 + count);
         LCD.text(itoa(temp/16, strBuffer, 10));
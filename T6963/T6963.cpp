@@ -116,6 +116,38 @@
 
 
 
+//*************************************************************************************************
+//	Host emulator
+//*************************************************************************************************
+
+#elif defined T6963_EMULATOR
+
+// data port macros
+#define GLCD_SET_PORT_MODE_READ
+#define GLCD_SET_PORT_MODE_WRITE
+
+#define GLCD_ReadPort(data)			(data = t6963_emu.bus)
+#define GLCD_WritePort(data)		(t6963_emu.bus = data)
+
+// control port
+#define GLCD_CTRL_DDR		t6963_emu.ddr
+
+// control bits
+#define GLCD_WR			2
+#define GLCD_RD			3
+#define GLCD_CE			4
+#define GLCD_CD			5
+
+// control macros (a strobe is one bus cycle on the model)
+#define GLCD_CONTROL_RESET
+#define GLCD_CONTROL_READ_STATUS	(t6963_emu.bus = t6963_emu_status())
+#define GLCD_CONTROL_READ_DATA		(t6963_emu.bus = t6963_emu_read())
+#define GLCD_CONTROL_WRITE_COMMAND	t6963_emu_command(t6963_emu.bus)
+#define GLCD_CONTROL_WRITE_DATA		t6963_emu_data(t6963_emu.bus)
+
+
+
+
 //*************************************************************************************************
 //	Single data port
 //*************************************************************************************************
@@ -158,15 +190,37 @@
 //*************************************************************************************************
 
 // control macros
+#ifndef T6963_EMULATOR
 #define GLCD_CONTROL_RESET			(GLCD_CTRL_PORT |= (1 << GLCD_CE) | (1 << GLCD_RD) | (1 << GLCD_WR) | (1 << GLCD_CD))
 #define GLCD_CONTROL_READ_STATUS	(GLCD_CTRL_PORT &= ~((1 << GLCD_CE) | (1 << GLCD_RD)))
 #define GLCD_CONTROL_READ_DATA		(GLCD_CTRL_PORT &= ~((1 << GLCD_CE) | (1 << GLCD_RD) | (1 << GLCD_CD)))
 #define GLCD_CONTROL_WRITE_COMMAND	(GLCD_CTRL_PORT &= ~((1 << GLCD_CE) | (1 << GLCD_WR)))
 #define GLCD_CONTROL_WRITE_DATA		(GLCD_CTRL_PORT &= ~((1 << GLCD_CE) | (1 << GLCD_WR) | (1 << GLCD_CD)))
+#endif
+
+
+#define GLCD_WriteWord(data, cmd)	(writeData(0xFF & (data)), writeData((data) >> 8), writeCommand(cmd))
+#define GLCD_SetAddress(addr)		(GLCD_COUNT(addressLoads), GLCD_WriteWord(addr, T6963_SET_ADDRESS_POINTER))
+
+
+// bus cycle counters
+#ifdef T6963_COUNTERS
+#define GLCD_COUNT(counter)			(counters.counter++)
+#else
+#define GLCD_COUNT(counter)			((void)0)
+#endif
 
 
-#define GLCD_WriteWord(data, cmd)	(writeData(0xFF & data), writeData(data >> 8), writeCommand(cmd))
-#define GLCD_SetAddress(addr)		GLCD_WriteWord(addr, T6963_SET_ADDRESS_POINTER)
+// page being drawn on
+#ifdef T6963_PAGES
+#define PAGE_TEXT_START				_textStart
+#define PAGE_GRAPH_START			_graphStart
+#else
+#define PAGE_TEXT_START				MEM_TEXT_START
+#define PAGE_GRAPH_START			MEM_GRAPH_START
+#endif
+
+#define PAGE_TEXT_END				(PAGE_TEXT_START+MEM_TEXT_AREA)
 
 
 // other macros
@@ -178,6 +232,10 @@
 #define min(a,b) ((a)<(b)?(a):(b))
 #endif
 
+#ifndef max
+#define max(a,b) ((a)>(b)?(a):(b))
+#endif
+
 
 
 
@@ -236,6 +294,8 @@ uint8_t T6963::readStatus(void)
 {
 	uint8_t tmp;
 	
+	GLCD_COUNT(statusReads);
+	
 	GLCD_SET_PORT_MODE_READ;
 	GLCD_CONTROL_READ_STATUS;
 	
@@ -262,7 +322,12 @@ uint8_t T6963::readData(void)
 {
 	uint8_t tmp;
 	
-	while(!(readStatus() & 0x03));
+	GLCD_COUNT(dataReads);
+	
+	while(!(readStatus() & 0x03))
+	{
+		GLCD_COUNT(statusSpins);
+	}
 	
 	GLCD_SET_PORT_MODE_READ;
 	GLCD_CONTROL_READ_DATA;
@@ -288,7 +353,12 @@ uint8_t T6963::readData(void)
 
 void T6963::writeCommand(uint8_t command)
 {
-	while(!(readStatus() & 0x03));
+	GLCD_COUNT(commandWrites);
+	
+	while(!(readStatus() & 0x03))
+	{
+		GLCD_COUNT(statusSpins);
+	}
 	
 	GLCD_WritePort(command);
 	GLCD_CONTROL_WRITE_COMMAND;
@@ -310,7 +380,12 @@ void T6963::writeCommand(uint8_t command)
 
 void T6963::writeData(uint8_t data)
 {
-	while(!(readStatus() & 0x03));
+	GLCD_COUNT(dataWrites);
+	
+	while(!(readStatus() & 0x03))
+	{
+		GLCD_COUNT(statusSpins);
+	}
 	
 	GLCD_WritePort(data);
 	GLCD_CONTROL_WRITE_DATA;
@@ -320,6 +395,23 @@ void T6963::writeData(uint8_t data)
 	GLCD_CONTROL_RESET;
 }
 
+#ifdef T6963_COUNTERS
+//-------------------------------------------------------------------------------------------------
+//
+// Reset the bus cycle counters
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::resetCounters(void)
+{
+	memset(&counters, 0, sizeof(COUNTERS));
+}
+#endif
+
 
 
 
@@ -379,7 +471,7 @@ void T6963::setDisplay(uint8_t settings)
 
 //-------------------------------------------------------------------------------------------------
 //
-// Set the address pointer in display memory
+// Set the address pointer in display memory (skipped if it already points there)
 //
 //	Input	none
 //
@@ -389,10 +481,7 @@ void T6963::setDisplay(uint8_t settings)
 
 void T6963::setAddress(void)
 {
-	GLCD_SetAddress(_address);
-	//writeData(_address & 0xFF);
-	//writeData(_address >> 8);
-	//writeCommand(T6963_SET_ADDRESS_POINTER);
+	loadPointer(_address);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -407,10 +496,26 @@ void T6963::setAddress(void)
 
 void T6963::setText(void)
 {
-	GLCD_SetAddress(_text);
-	//writeData(_text & 0xFF);
-	//writeData(_text >> 8);
-	//writeCommand(T6963_SET_ADDRESS_POINTER);
+	loadPointer(_text);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Load the controller address pointer (skipped if it already points there)
+//
+//	Input	address: display memory address
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::loadPointer(uint16_t address)
+{
+	if (_pointer != address)
+	{
+		GLCD_SetAddress(address);
+		_pointer = address;
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -477,6 +582,8 @@ uint8_t T6963::readByte(void)
 uint8_t T6963::readByteInc(void)
 {
 	writeCommand(T6963_DATA_READ_AND_INCREMENT);
+	_pointer++;
+	
 	return readData();
 }
 
@@ -493,6 +600,8 @@ uint8_t T6963::readByteInc(void)
 uint8_t T6963::readByteDec(void)
 {
 	writeCommand(T6963_DATA_READ_AND_DECREMENT);
+	_pointer--;
+	
 	return readData();
 }
 
@@ -526,6 +635,7 @@ void T6963::writeByteInc(uint8_t data)
 {
 	writeData(data);
 	writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
+	_pointer++;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -542,6 +652,7 @@ void T6963::writeByteDec(uint8_t data)
 {
 	writeData(data);
 	writeCommand(T6963_DATA_WRITE_AND_DECREMENT);
+	_pointer--;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -573,12 +684,175 @@ void T6963::writeBit(uint8_t data)
 
 void T6963::writeBlock(uint8_t data, uint16_t size)
 {
+	if (size == 0)
+	{
+		return;
+	}
+	
+	// a single byte is cheaper without entering auto mode
+	if (size == 1)
+	{
+		writeByteInc(data);
+		return;
+	}
+	
+	autoWriteStart();
+	
 	while (size > 0)
 	{
-		writeData(data);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
+		autoWrite(data);
 		size--;
 	}
+	
+	autoWriteStop();
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Start an auto write burst at the address pointer
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::autoWriteStart(void)
+{
+	writeCommand(T6963_SET_DATA_AUTO_WRITE);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Write data in auto write mode (address pointer increments)
+//
+//	Input	data: the data to send
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::autoWrite(uint8_t data)
+{
+	GLCD_COUNT(dataWrites);
+	
+	while(!(readStatus() & T6963_STATUS_AUTO_WRITE))
+	{
+		GLCD_COUNT(statusSpins);
+	}
+	
+	GLCD_WritePort(data);
+	GLCD_CONTROL_WRITE_DATA;
+	
+	n_delay();
+	
+	GLCD_CONTROL_RESET;
+	
+	_pointer++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// End an auto write burst
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::autoWriteStop(void)
+{
+	GLCD_COUNT(commandWrites);
+	
+	while(!(readStatus() & T6963_STATUS_AUTO_WRITE))
+	{
+		GLCD_COUNT(statusSpins);
+	}
+	
+	GLCD_WritePort(T6963_AUTO_RESET);
+	GLCD_CONTROL_WRITE_COMMAND;
+	
+	n_delay();
+	
+	GLCD_CONTROL_RESET;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Start an auto read burst at the address pointer
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::autoReadStart(void)
+{
+	writeCommand(T6963_SET_DATA_AUTO_READ);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Read data in auto read mode (address pointer increments)
+//
+//	Input	none
+//
+//	Output	data read
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t T6963::autoRead(void)
+{
+	uint8_t tmp;
+	
+	GLCD_COUNT(dataReads);
+	
+	while(!(readStatus() & T6963_STATUS_AUTO_READ))
+	{
+		GLCD_COUNT(statusSpins);
+	}
+	
+	GLCD_SET_PORT_MODE_READ;
+	GLCD_CONTROL_READ_DATA;
+	
+	n_delay();
+	GLCD_ReadPort(tmp);
+	
+	GLCD_CONTROL_RESET;
+	
+	_pointer++;
+	GLCD_SET_PORT_MODE_WRITE;
+	
+	return tmp;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// End an auto read burst
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::autoReadStop(void)
+{
+	GLCD_COUNT(commandWrites);
+	
+	while(!(readStatus() & T6963_STATUS_AUTO_READ))
+	{
+		GLCD_COUNT(statusSpins);
+	}
+	
+	GLCD_WritePort(T6963_AUTO_RESET);
+	GLCD_CONTROL_WRITE_COMMAND;
+	
+	n_delay();
+	
+	GLCD_CONTROL_RESET;
 }
 
 
@@ -656,124 +930,223 @@ void T6963::writeBlock(uint8_t data, uint8_t width, uint8_t height)
 
 //-------------------------------------------------------------------------------------------------
 //
-// Draw a horizontal line
+// Draw a single pixel at the current address in the current color
 //
-//	Input	length: line length
+//	Input	bit: pixel bit in the current byte
 //
 //	Output	none
 //
 //-------------------------------------------------------------------------------------------------
 
-void T6963::horizLine(int16_t length)
+void T6963::plot(uint8_t bit)
 {
-	uint8_t cmd, bit;
-	
-	cmd = T6963_SET_PIXEL | _color;
-	
-	if (length > 0)
+	#ifdef T6963_SHADOW
+	if (shadowed())
 	{
-		if (_bit - length < 0)
+		uint16_t offset = _address - _shadowStart;
+		
+		if (_color)
 		{
-			_bit++;
-			length -= _bit;
-			
-			while (_bit > 0)
-			{
-				_bit--;
-				writeCommand(cmd | _bit);
-				
-			}
-			
-			_bit = FONT_WIDTH - 1;
-			_address++;
-			setAddress();
-			
-			if (length >= FONT_WIDTH)
-			{
-				uint8_t col, data;
-				
-				col = length / FONT_WIDTH;
-				_address += col;
-				length -= col * FONT_WIDTH;
-				
-				data = _color ? 0xFF : 0;
-				
-				while (col > 0)
-				{
-					writeData(data);
-					writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
-					col--;
-				}
-				
-				if (length == 0)
-				{
-					return;
-				}
-			}
+			_shadow[offset] |= (1 << bit);
 		}
-		
-		bit = _bit - length;
-		
-		while (_bit > bit)
+		else
 		{
-			writeCommand(cmd | _bit);
-			_bit--;
+			_shadow[offset] &= ~(1 << bit);
 		}
 		
+		markDirty(offset, 1);
 		return;
 	}
+	#endif
 	
-	if (length < 0)
+	setAddress();
+	writeCommand(T6963_SET_PIXEL | _color | bit);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Draw a run of pixels within the byte at the current address in the current color
+//
+//	Input	bits: mask of the pixel bits to draw
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::edge(uint8_t bits)
+{
+	uint8_t data, count;
+	
+	#ifdef T6963_SHADOW
+	if (shadowed())
 	{
-		length = -length;
+		uint16_t offset = _address - _shadowStart;
 		
-		if (_bit + length > FONT_WIDTH - 1)
+		if (_color)
 		{
-			length -= FONT_WIDTH - _bit;
-			
-			while (_bit < FONT_WIDTH)
-			{
-				writeCommand(cmd | _bit);
-				_bit++;
-			}
-			
-			_bit = 0;
-			_address--;
-			setAddress();
-			
-			if (length > FONT_WIDTH - 1)
-			{
-				uint8_t col, data;
-				
-				col = length / FONT_WIDTH;
-				_address -= col;
-				length -= col * FONT_WIDTH;
-				
-				data = _color ? 0xFF : 0;
+			_shadow[offset] |= bits;
+		}
+		else
+		{
+			_shadow[offset] &= ~bits;
+		}
+		
+		markDirty(offset, 1);
+		return;
+	}
+	#endif
+	
+	count = 0;
+	
+	for (data = bits; data; data >>= 1)
+	{
+		count += data & 0x01;
+	}
+	
+	// a read-modify-write costs about as much as four single pixel commands
+	if (count > 4)
+	{
+		setAddress();
+		data = readByte();
+		writeByte(_color ? (data | bits) : (data & ~bits));
+		return;
+	}
+	
+	for (count = 0; bits; count++, bits >>= 1)
+	{
+		if (bits & 0x01)
+		{
+			plot(count);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Fill whole bytes from the current address and advance past them
+//
+//	Input	data: byte of data
+//			size: number of bytes (can be negative to write backward)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::fill(uint8_t data, int16_t size)
+{
+	#ifdef T6963_SHADOW
+	if (shadowed())
+	{
+		uint16_t offset = _address - _shadowStart;
+		
+		if (size < 0)
+		{
+			offset += size + 1;
+			_address += size;
+			size = -size;
+		}
+		else
+		{
+			_address += size;
+		}
+		
+		memset(&_shadow[offset], data, size);
+		markDirty(offset, size);
+		return;
+	}
+	#endif
+	
+	setAddress();
+	
+	if (size > 0)
+	{
+		writeBlock(data, size);
+		_address += size;
+	}
+	
+	while (size < 0)
+	{
+		writeByteDec(data);
+		_address--;
+		size++;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+//
+// Draw a horizontal line
+//
+//	Input	length: line length
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::horizLine(int16_t length)
+{
+	if (length > 0)
+	{
+		if (_bit - length < 0)
+		{
+			length -= _bit + 1;
+			edge((2 << _bit) - 1);
+			
+			_bit = FONT_WIDTH - 1;
+			_address++;
+			
+			if (length >= FONT_WIDTH)
+			{
+				uint8_t col;
 				
-				while (col > 0)
-				{
-					writeData(data);
-					writeCommand(T6963_DATA_WRITE_AND_DECREMENT);
-					col--;
-				}
+				col = (uint16_t)length / FONT_WIDTH;
+				length -= col * FONT_WIDTH;
 				
-				if (length == 0)
-				{
-					return;
-				}
+				fill(_color ? 0xFF : 0, col);
 			}
 			
-			
+			if (length == 0)
+			{
+				return;
+			}
 		}
 		
-		bit = _bit + length;
+		edge(((2 << _bit) - 1) & ~((2 << (_bit - length)) - 1));
+		_bit -= length;
+		
+		return;
+	}
+	
+	if (length < 0)
+	{
+		length = -length;
 		
-		while (_bit < bit)
+		if (_bit + length > FONT_WIDTH - 1)
 		{
-			writeCommand(cmd | _bit);
-			_bit++;
+			length -= FONT_WIDTH - _bit;
+			edge(((1 << FONT_WIDTH) - 1) & ~((1 << _bit) - 1));
+			
+			_bit = 0;
+			_address--;
+			
+			if (length > FONT_WIDTH - 1)
+			{
+				uint8_t col;
+				
+				col = (uint16_t)length / FONT_WIDTH;
+				length -= col * FONT_WIDTH;
+				
+				fill(_color ? 0xFF : 0, -col);
+			}
+			
+			if (length == 0)
+			{
+				return;
+			}
 		}
+		
+		edge(((1 << (_bit + length)) - 1) & ~((1 << _bit) - 1));
+		_bit += length;
 	}
 }
 
@@ -789,18 +1162,13 @@ void T6963::horizLine(int16_t length)
 
 void T6963::vertLine(int16_t length)
 {
-	uint8_t cmd;
-	
-	cmd = T6963_SET_PIXEL | _color | _bit;
-	
 	if (length > 0)
 	{
 		do
 		{
-			writeCommand(cmd);
+			plot(_bit);
 			
 			_address += MEM_GRAPH_WIDTH;
-			setAddress();
 			
 			length--;
 		}
@@ -813,10 +1181,9 @@ void T6963::vertLine(int16_t length)
 	{
 		do
 		{
-			writeCommand(cmd);
+			plot(_bit);
 			
 			_address -= MEM_GRAPH_WIDTH;
-			setAddress();
 			
 			length++;
 		}
@@ -837,10 +1204,8 @@ void T6963::vertLine(int16_t length)
 
 void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 {
-	uint8_t cmd;
 	int16_t dy;
 	
-	cmd = T6963_SET_PIXEL | _color;
 	dy =  MEM_GRAPH_WIDTH;
 	
 	if (yIsNeg)
@@ -852,7 +1217,7 @@ void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 	{
 		do
 		{
-			writeCommand(cmd | _bit);
+			plot(_bit);
 			
 			if (_bit > 0)
 			{
@@ -865,7 +1230,6 @@ void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 			}
 			
 			_address += dy;
-			setAddress();
 			
 			dx--;
 		}
@@ -878,7 +1242,7 @@ void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 	{
 		do
 		{
-			writeCommand(cmd | _bit);
+			plot(_bit);
 			
 			if (_bit < FONT_WIDTH - 1)
 			{
@@ -891,7 +1255,6 @@ void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 			}
 			
 			_address += dy;
-			setAddress();
 			
 			dx++;
 		}
@@ -913,8 +1276,8 @@ void T6963::diagLine(int16_t dx, uint8_t yIsNeg)
 void T6963::bresenLine(int16_t dx, int16_t dy)
 {
 	uint16_t errInc, errDec;
-	int16_t mem, error;
-	int8_t incX, incY, step;
+	int16_t mem, error, step;
+	int8_t incX, incY;
 	
 	mem = MEM_GRAPH_WIDTH;
 	incX = 1;
@@ -946,7 +1309,6 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 		
 		horizLine(step / 2 + (errInc == 0 && (step & 0x01) == 0 ? 0 : incX));
 		_address += mem;
-		setAddress();
 		
 		dy -= 1;
 		
@@ -965,7 +1327,6 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 			}
 			
 			_address += mem;
-			setAddress();
 			
 			dy--;
 		}
@@ -986,7 +1347,6 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 		vertLine(step / 2 - (errInc == 0 && (step & 0x01) == 0 ? incY : 0));
 		horizLine(incX);
 		_address += mem;
-		setAddress();
 		
 		dx -= 1;
 		
@@ -1006,7 +1366,6 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 			
 			horizLine(incX);
 			_address += mem;
-			setAddress();
 			
 			dx--;
 		}
@@ -1034,6 +1393,196 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 
 
 
+
+
+
+
+
+
+#ifdef T6963_SHADOW
+//*************************************************************************************************
+//
+//		Shadow Buffer Functions
+//
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Check if the current address is held in the shadow buffer
+//
+//	Input	none
+//
+//	Output	0 controller memory
+//			1 shadow buffer
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t T6963::shadowed(void)
+{
+	return (_shadowOn && _address >= _shadowStart && _address < _shadowStart + T6963_SHADOW_SIZE) ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Mark a span of the shadow buffer as changed
+//
+//	Input	offset: first byte in the shadow buffer
+//			size: number of bytes
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::markDirty(uint16_t offset, uint16_t size)
+{
+	uint8_t row, left, right;
+	
+	row = offset / MEM_GRAPH_WIDTH;
+	left = offset - row * MEM_GRAPH_WIDTH;
+	right = left + size - 1;
+	
+	if (left < _dirtyLeft[row])
+	{
+		_dirtyLeft[row] = left;
+	}
+	
+	if (right > _dirtyRight[row] || _dirtyRight[row] == T6963_SHADOW_CLEAN)
+	{
+		_dirtyRight[row] = right;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Draw into a band of graphic rows held in ram (loads the band from the display)
+//
+//	Input	top: first graphic row of the band
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::shadowBegin(uint8_t top)
+{
+	uint16_t count;
+	
+	shadowEnd();
+	
+	top = min(top, SCREEN_HEIGHT - T6963_SHADOW_ROWS);
+	_shadowStart = PAGE_GRAPH_START + top * MEM_GRAPH_WIDTH;
+	
+	loadPointer(_shadowStart);
+	autoReadStart();
+	
+	for (count = 0; count < T6963_SHADOW_SIZE; count++)
+	{
+		_shadow[count] = autoRead();
+	}
+	
+	autoReadStop();
+	
+	for (count = 0; count < T6963_SHADOW_ROWS; count++)
+	{
+		_dirtyLeft[count] = T6963_SHADOW_CLEAN;
+		_dirtyRight[count] = T6963_SHADOW_CLEAN;
+	}
+	
+	_shadowOn = 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Flush the band and draw straight to the display again
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::shadowEnd(void)
+{
+	if (_shadowOn)
+	{
+		flush();
+		_shadowOn = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Write the changed spans of the shadow buffer to the display
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::flush(void)
+{
+	uint16_t offset, next;
+	uint8_t row, col, burst;
+	
+	if (!_shadowOn)
+	{
+		return;
+	}
+	
+	burst = 0;
+	next = 0;
+	
+	for (row = 0; row < T6963_SHADOW_ROWS; row++)
+	{
+		if (_dirtyLeft[row] == T6963_SHADOW_CLEAN)
+		{
+			continue;
+		}
+		
+		offset = row * MEM_GRAPH_WIDTH + _dirtyLeft[row];
+		
+		// spans that run on from the last one continue the same burst
+		if (!burst || offset != next)
+		{
+			if (burst)
+			{
+				autoWriteStop();
+			}
+			
+			loadPointer(_shadowStart + offset);
+			autoWriteStart();
+			burst = 1;
+		}
+		
+		for (col = _dirtyLeft[row]; col <= _dirtyRight[row]; col++)
+		{
+			autoWrite(_shadow[offset]);
+			offset++;
+		}
+		
+		next = offset;
+		
+		_dirtyLeft[row] = T6963_SHADOW_CLEAN;
+		_dirtyRight[row] = T6963_SHADOW_CLEAN;
+	}
+	
+	if (burst)
+	{
+		autoWriteStop();
+	}
+}
+#endif
+
+
+
+
+
+
+
+
+
+
+
 
 
 
@@ -1058,14 +1607,23 @@ void T6963::bresenLine(int16_t dx, int16_t dy)
 
 void T6963::clearGraph(void)
 {
-	uint16_t tmp = _address;
-	
-	_address = MEM_GRAPH_START;
-	setAddress();
+	loadPointer(PAGE_GRAPH_START);
 	writeBlock(0, MEM_GRAPH_AREA);
 	
-	_address = tmp;
-	setAddress();
+	#ifdef T6963_SHADOW
+	if (_shadowOn)
+	{
+		uint8_t row;
+		
+		memset(_shadow, 0, T6963_SHADOW_SIZE);
+		
+		for (row = 0; row < T6963_SHADOW_ROWS; row++)
+		{
+			_dirtyLeft[row] = T6963_SHADOW_CLEAN;
+			_dirtyRight[row] = T6963_SHADOW_CLEAN;
+		}
+	}
+	#endif
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1125,8 +1683,6 @@ void T6963::move(int16_t dx, int16_t dy)
 		_address += dy * MEM_GRAPH_WIDTH;
 		
 	}
-	
-	setAddress();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1151,10 +1707,8 @@ void T6963::moveTo(uint8_t x, uint8_t y)
 		
 		col = x / FONT_WIDTH;
 		
-		_address = MEM_GRAPH_START + MEM_GRAPH_WIDTH * y + col;
+		_address = PAGE_GRAPH_START + MEM_GRAPH_WIDTH * y + col;
 		_bit = (col + 1) * FONT_WIDTH - x - 1;
-		
-		setAddress();
 	}
 }
 
@@ -1330,10 +1884,58 @@ void T6963::rect(int16_t dx, int16_t dy, uint8_t diag)
 
 //-------------------------------------------------------------------------------------------------
 //
-// Draw a rectangle to a point in graphic memory
+// Draw a filled rectangle relative to a point in graphic memory
 //
-//	Input	x: new x
-//			y: new y
+//	Input	dx: width
+//			dy: height
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::fillRect(int16_t dx, int16_t dy)
+{
+	if (dx < (SCREEN_WIDTH - _lastX) && dx >= (0 - _lastX) && dy < (SCREEN_HEIGHT - _lastY) && dy >= (0 - _lastY))
+	{
+		uint16_t address, row;
+		int16_t step;
+		uint8_t bit, rows;
+		
+		address = _address;
+		bit = _bit;
+		
+		step = MEM_GRAPH_WIDTH;
+		rows = dy + 1;
+		
+		if (dy < 0)
+		{
+			step = -step;
+			rows = 1 - dy;
+		}
+		
+		// cover the same pixels as the outline drawn by rect
+		dx += (dx < 0) ? -1 : 1;
+		
+		for (row = address; rows > 0; rows--)
+		{
+			_address = row;
+			_bit = bit;
+			horizLine(dx);
+			
+			row += step;
+		}
+		
+		_address = address;
+		_bit = bit;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Draw a rectangle to a point in graphic memory
+//
+//	Input	x: new x
+//			y: new y
 //
 //	Output	none
 //
@@ -1388,6 +1990,212 @@ void T6963::rectTo(uint8_t x, uint8_t y)
 
 
 
+//*************************************************************************************************
+//
+//		Bitmap Functions
+//
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Draw a bitmap from program memory, clipped to the screen
+//
+//	Input	x: left edge (can be off screen)
+//			y: top edge (can be off screen)
+//			*bitmap: pointer to program memory bitmap (rows of 1 bit pixels, msb first, byte padded)
+//			width: width of bitmap
+//			height: height of bitmap
+//			op: BLIT_COPY, BLIT_OR, BLIT_XOR or BLIT_AND
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::blit(int16_t x, int16_t y, prog_uchar *bitmap, uint8_t width, uint8_t height, uint8_t op)
+{
+	uint8_t line[MEM_GRAPH_WIDTH];
+	uint8_t rowBytes, col0, col1, count, mask0, mask1, i;
+	int16_t left, right, top, bottom, row;
+	
+	left = max(x, 0);
+	right = min(x + width, SCREEN_WIDTH) - 1;
+	top = max(y, 0);
+	bottom = min(y + height, SCREEN_HEIGHT) - 1;
+	
+	if (left > right || top > bottom)
+	{
+		return;
+	}
+	
+	rowBytes = (width + 7) >> 3;
+	
+	col0 = left / FONT_WIDTH;
+	col1 = right / FONT_WIDTH;
+	count = col1 - col0 + 1;
+	
+	// pixels outside the bitmap in the first and last byte are left alone
+	mask0 = (2 << ((col0 + 1) * FONT_WIDTH - left - 1)) - 1;
+	mask1 = ((1 << FONT_WIDTH) - 1) & ~((1 << ((col1 + 1) * FONT_WIDTH - right - 1)) - 1);
+	
+	if (count == 1)
+	{
+		mask0 &= mask1;
+	}
+	
+	for (row = top; row <= bottom; row++)
+	{
+		prog_uchar *data;
+		uint8_t *dest;
+		uint16_t address;
+		
+		data = bitmap + (row - y) * rowBytes;
+		address = PAGE_GRAPH_START + row * MEM_GRAPH_WIDTH + col0;
+		dest = line;
+		
+		#ifdef T6963_SHADOW
+		if (_shadowOn && address >= _shadowStart && address < _shadowStart + T6963_SHADOW_SIZE)
+		{
+			dest = _shadow + (address - _shadowStart);
+		}
+		else
+		#endif
+		if (op != BLIT_COPY)
+		{
+			loadPointer(address);
+			autoReadStart();
+			
+			for (i = 0; i < count; i++)
+			{
+				line[i] = autoRead();
+			}
+			
+			autoReadStop();
+		}
+		else
+		{
+			// copy only needs the bytes shared with other pixels
+			if (mask0 != (1 << FONT_WIDTH) - 1)
+			{
+				loadPointer(address);
+				line[0] = readByte();
+			}
+			
+			if (count > 1 && mask1 != (1 << FONT_WIDTH) - 1)
+			{
+				loadPointer(address + count - 1);
+				line[count - 1] = readByte();
+			}
+		}
+		
+		for (i = 0; i < count; i++)
+		{
+			uint8_t bits, mask;
+			
+			bits = bitmapBits(data, rowBytes, (col0 + i) * FONT_WIDTH - x);
+			
+			mask = (1 << FONT_WIDTH) - 1;
+			
+			if (i == 0)
+			{
+				mask = mask0;
+			}
+			else if (i == count - 1)
+			{
+				mask = mask1;
+			}
+			
+			bits &= mask;
+			
+			switch (op)
+			{
+				case BLIT_COPY:
+					dest[i] = (dest[i] & ~mask) | bits;
+					break;
+					
+				case BLIT_OR:
+					dest[i] |= bits;
+					break;
+					
+				case BLIT_XOR:
+					dest[i] ^= bits;
+					break;
+					
+				case BLIT_AND:
+					dest[i] &= bits | ~mask;
+					break;
+			}
+		}
+		
+		#ifdef T6963_SHADOW
+		if (dest != line)
+		{
+			markDirty(address - _shadowStart, count);
+			continue;
+		}
+		#endif
+		
+		loadPointer(address);
+		autoWriteStart();
+		
+		for (i = 0; i < count; i++)
+		{
+			autoWrite(line[i]);
+		}
+		
+		autoWriteStop();
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get one byte worth of pixels from a bitmap row
+//
+//	Input	*data: pointer to program memory bitmap row
+//			rowBytes: bytes in a row
+//			start: first pixel (can be negative)
+//
+//	Output	pixels aligned to the font width, first pixel in the high bit
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t T6963::bitmapBits(prog_uchar *data, uint8_t rowBytes, int16_t start)
+{
+	int16_t index;
+	uint16_t window;
+	
+	index = start >> 3;
+	window = 0;
+	
+	if (index >= 0 && index < rowBytes)
+	{
+		window = pgm_read_byte(data + index) << 8;
+	}
+	
+	if (index + 1 >= 0 && index + 1 < rowBytes)
+	{
+		window |= pgm_read_byte(data + index + 1);
+	}
+	
+	return (window >> (16 - FONT_WIDTH - (start & 7))) & ((1 << FONT_WIDTH) - 1);
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
 //*************************************************************************************************
 //
 //		Basic Text Functions
@@ -1406,11 +2214,10 @@ void T6963::rectTo(uint8_t x, uint8_t y)
 
 void T6963::clearText(void)
 {
-	_text = MEM_TEXT_START;
+	_text = PAGE_TEXT_START;
 	setText();
 	writeBlock(0, MEM_TEXT_AREA);
-	
-	setAddress();
+
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1427,24 +2234,20 @@ void T6963::clearText(int16_t size)
 {
 	setText();
 	
-	size = constrain(size, MEM_TEXT_START - _text, (MEM_TEXT_END - 1) - _text);
+	size = constrain(size, (int16_t)(PAGE_TEXT_START - _text), (int16_t)((PAGE_TEXT_END - 1) - _text));
 	_text += size;
 	
-	while (size > 0)
+	if (size > 0)
 	{
-		writeData(0);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
-		size--;
+		writeBlock(0, size);
 	}
 	
 	while (size < 0)
 	{
-		writeData(0);
-		writeCommand(T6963_DATA_WRITE_AND_DECREMENT);
+		writeByteDec(0);
 		size++;
 	}
-	
-	setAddress();
+
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1460,7 +2263,7 @@ void T6963::clearText(int16_t size)
 
 void T6963::text(int16_t col, int16_t row)
 {
-	_text = constrain(_text + MEM_TEXT_WIDTH * row + col, 0, MEM_TEXT_END - 1);
+	_text = constrain(_text + MEM_TEXT_WIDTH * row + col, PAGE_TEXT_START, PAGE_TEXT_END - 1);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1476,7 +2279,7 @@ void T6963::text(int16_t col, int16_t row)
 
 void T6963::textTo(uint8_t col, uint8_t row)
 {
-	_text = min(MEM_TEXT_START + MEM_TEXT_WIDTH * row + col, MEM_TEXT_END - 1);
+	_text = min(PAGE_TEXT_START + MEM_TEXT_WIDTH * row + col, PAGE_TEXT_END - 1);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1492,16 +2295,16 @@ void T6963::textTo(uint8_t col, uint8_t row)
 void T6963::text(char *string)
 {
 	setText();
+	autoWriteStart();
 	
-	while (_text < MEM_TEXT_END && *string)
+	while (_text < PAGE_TEXT_END && *string)
 	{
-		writeData((*string) - 32);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
+		autoWrite((*string) - 32);
 		string++;
 		_text++;
 	}
 	
-	setAddress();
+	autoWriteStop();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1519,26 +2322,30 @@ void T6963::text(char *string, int16_t size)
 {
 	setText();
 	
-	size = constrain(size, MEM_TEXT_START - _text, (MEM_TEXT_END - 1) - _text);
+	size = constrain(size, (int16_t)(PAGE_TEXT_START - _text), (int16_t)((PAGE_TEXT_END - 1) - _text));
 	_text += size;
 	
-	while (size > 0 && *string)
+	if (size > 0)
 	{
-		writeData((*string) - 32);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
-		string++;
-		size--;
+		autoWriteStart();
+		
+		while (size > 0 && *string)
+		{
+			autoWrite((*string) - 32);
+			string++;
+			size--;
+		}
+		
+		autoWriteStop();
 	}
 	
 	while (size < 0 && *string)
 	{
-		writeData((*string) - 32);
-		writeCommand(T6963_DATA_WRITE_AND_DECREMENT);
+		writeByteDec((*string) - 32);
 		string++;
 		size++;
 	}
-	
-	setAddress();
+
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1558,16 +2365,16 @@ void T6963::textPgm(prog_char *string)
 	char charCode;
 	
 	setText();
+	autoWriteStart();
 	
-	while (_text < MEM_TEXT_END && (charCode = pgm_read_byte(string)))
+	while (_text < PAGE_TEXT_END && (charCode = pgm_read_byte(string)))
 	{
-		writeData(charCode - 32);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
+		autoWrite(charCode - 32);
 		string++;
 		_text++;
 	}
 	
-	setAddress();
+	autoWriteStop();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -1587,28 +2394,209 @@ void T6963::textPgm(prog_char *string, int16_t size)
 	
 	setText();
 	
-	size = constrain(size, MEM_TEXT_START - _text, (MEM_TEXT_END - 1) - _text);
+	size = constrain(size, (int16_t)(PAGE_TEXT_START - _text), (int16_t)((PAGE_TEXT_END - 1) - _text));
 	_text += size;
 	
-	while (size > 0 && (charCode = pgm_read_byte(string)))
+	if (size > 0)
 	{
-		writeData(charCode - 32);
-		writeCommand(T6963_DATA_WRITE_AND_INCREMENT);
-		string++;
-		size--;
+		autoWriteStart();
+		
+		while (size > 0 && (charCode = pgm_read_byte(string)))
+		{
+			autoWrite(charCode - 32);
+			string++;
+			size--;
+		}
+		
+		autoWriteStop();
 	}
 	
 	while (size < 0 && (charCode = pgm_read_byte(string)))
 	{
-		writeData(charCode - 32);
-		writeCommand(T6963_DATA_WRITE_AND_DECREMENT);
+		writeByteDec(charCode - 32);
 		string++;
 		size++;
 	}
+
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+#ifdef T6963_CONSOLE
+//*************************************************************************************************
+//
+//		Console Functions
+//
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Show the scrolling console in place of the text area
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::consoleBegin(void)
+{
+	loadPointer(MEM_CONSOLE_START);
+	writeBlock(0, MEM_CONSOLE_AREA);
+	
+	_consoleTop = 0;
+	_consoleRows = 0;
+	
+	GLCD_WriteWord(MEM_CONSOLE_START, T6963_SET_TEXT_HOME_ADDRESS);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Show the text area again
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::consoleEnd(void)
+{
+	#ifdef T6963_PAGES
+	GLCD_WriteWord((_page) ? MEM_PAGE_TEXT_START : MEM_TEXT_START, T6963_SET_TEXT_HOME_ADDRESS);
+	#else
+	GLCD_WriteWord(MEM_TEXT_START, T6963_SET_TEXT_HOME_ADDRESS);
+	#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Add a line to the bottom of the console (scrolls once the screen is full)
+//
+//	Input	*string: pointer to string
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::consoleLine(char *string)
+{
+	consoleWrite(consoleRow(), string, 0);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Add a line from program memory to the bottom of the console
+//
+//	Input	*string: pointer to program memory string
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::consoleLinePgm(prog_char *string)
+{
+	consoleWrite(consoleRow(), string, 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get the row for a new line, moving the text home address down a row when full
+//
+//	Input	none
+//
+//	Output	row in the console ring
+//
+//-------------------------------------------------------------------------------------------------
+
+uint8_t T6963::consoleRow(void)
+{
+	uint8_t row;
+	
+	if (_consoleRows < MEM_TEXT_HEIGHT)
+	{
+		return _consoleRows++;
+	}
 	
-	setAddress();
+	row = _consoleTop;
+	
+	_consoleTop++;
+	
+	if (_consoleTop == MEM_TEXT_HEIGHT)
+	{
+		_consoleTop = 0;
+	}
+	
+	GLCD_WriteWord(MEM_CONSOLE_START + _consoleTop * MEM_TEXT_WIDTH, T6963_SET_TEXT_HOME_ADDRESS);
+	
+	return row;
 }
 
+//-------------------------------------------------------------------------------------------------
+//
+// Write a row of the console (both copies, padded to the full width)
+//
+//	Input	row: row in the console ring
+//			*string: pointer to string
+//			pgm: string is in program memory
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::consoleWrite(uint8_t row, char *string, uint8_t pgm)
+{
+	uint16_t address;
+	uint8_t copy;
+	
+	address = MEM_CONSOLE_START + row * MEM_TEXT_WIDTH;
+	
+	for (copy = 0; copy < 2; copy++)
+	{
+		char *tmp, charCode;
+		uint8_t col;
+		
+		tmp = string;
+		
+		loadPointer(address);
+		autoWriteStart();
+		
+		for (col = 0; col < MEM_TEXT_WIDTH; col++)
+		{
+			charCode = (pgm) ? pgm_read_byte(tmp) : *tmp;
+			
+			if (charCode)
+			{
+				autoWrite(charCode - 32);
+				tmp++;
+			}
+			else
+			{
+				autoWrite(0);
+			}
+		}
+		
+		autoWriteStop();
+		
+		address += MEM_TEXT_AREA;
+	}
+}
+#endif
 
 
 
@@ -1628,13 +2616,13 @@ void T6963::textPgm(prog_char *string, int16_t size)
 
 //*************************************************************************************************
 //
-//		Character Graphic Functions
+//		Page Functions
 //
 //*************************************************************************************************
 
 //-------------------------------------------------------------------------------------------------
 //
-// Clear character memory
+// Start drawing a frame on the hidden page (draws on the shown page without a second page)
 //
 //	Input	none
 //
@@ -1642,16 +2630,126 @@ void T6963::textPgm(prog_char *string, int16_t size)
 //
 //-------------------------------------------------------------------------------------------------
 
-void T6963::clearCG(void)
+void T6963::beginFrame(void)
 {
-	uint16_t tmp = _address;
+	#ifdef T6963_PAGES
+	drawPage(!_page);
+	#endif
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Show the page the frame was drawn on (the shadow band is written out first)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::endFrame(void)
+{
+	#ifdef T6963_PAGES
+	uint8_t page;
 	
-	_address = MEM_CG_START;
-	setAddress();
-	writeBlock(0, MEM_CG_SIZE);
+	#ifdef T6963_SHADOW
+	flush();
+	#endif
 	
-	_address = tmp;
-	setAddress();
+	page = (_graphStart == MEM_GRAPH_START) ? 0 : 1;
+	
+	if (page != _page)
+	{
+		_page = page;
+		
+		GLCD_WriteWord(_textStart, T6963_SET_TEXT_HOME_ADDRESS);
+		GLCD_WriteWord(_graphStart, T6963_SET_GRAPHIC_HOME_ADDRESS);
+	}
+	#endif
+}
+
+#ifdef T6963_PAGES
+//-------------------------------------------------------------------------------------------------
+//
+// Select the page to draw on, keeping the text and graphic location (and the shadow band row)
+//
+//	Input	page: 0 first page, 1 second page
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::drawPage(uint8_t page)
+{
+	uint16_t textStart, graphStart;
+	
+	textStart = (page) ? MEM_PAGE_TEXT_START : MEM_TEXT_START;
+	graphStart = (page) ? MEM_PAGE_GRAPH_START : MEM_GRAPH_START;
+	
+	#ifdef T6963_SHADOW
+	uint8_t top, shadowOn;
+	
+	// flush the band to the old page and load the same rows from the new one
+	shadowOn = _shadowOn && graphStart != _graphStart;
+	top = (_shadowStart - _graphStart) / MEM_GRAPH_WIDTH;
+	
+	if (shadowOn)
+	{
+		shadowEnd();
+	}
+	#endif
+	
+	_text = _text - _textStart + textStart;
+	_address = _address - _graphStart + graphStart;
+	
+	_textStart = textStart;
+	_graphStart = graphStart;
+	
+	#ifdef T6963_SHADOW
+	if (shadowOn)
+	{
+		shadowBegin(top);
+	}
+	#endif
+}
+#endif
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+//*************************************************************************************************
+//
+//		Character Graphic Functions
+//
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Clear character memory (codes 0x80-0xFF)
+//
+//	Input	none
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+void T6963::clearCG(void)
+{
+	loadPointer(MEM_CG_RAM_START);
+	writeBlock(0, MEM_CG_RAM_SIZE);
 }
 
 
@@ -1689,6 +2787,14 @@ void T6963::clearCG(void)
 
 void T6963::init(void)
 {
+	#ifdef T6963_EMULATOR
+	t6963_emu_init(FONT_WIDTH, MEM_SIZE);
+	#endif
+	
+	#ifdef T6963_COUNTERS
+	resetCounters();
+	#endif
+	
 	GLCD_SET_PORT_MODE_WRITE;
 	GLCD_CTRL_DDR |= (1 << GLCD_WR) | (1 << GLCD_RD) | (1 << GLCD_CE) | (1 << GLCD_CD);
 	GLCD_CONTROL_RESET;
@@ -1711,11 +2817,27 @@ void T6963::init(void)
 	writeCommand(T6963_MODE_SET | T6963_MODE_INTERNAL | T6963_MODE_XOR);
 	writeCommand(T6963_DISPLAY_MODE | (1<<T6963_DISPLAY_TEXT) | (1<<T6963_DISPLAY_GRAPHIC) | (0<<T6963_DISPLAY_CURSOR) | (0<<T6963_DISPLAY_BLINK));
 	
+	_pointer = T6963_POINTER_UNKNOWN;
 	_address = 0;
 	_text = 0;
 	_bit = 0;
 	_color = T6963_BIT_SET;
 	
+	#ifdef T6963_SHADOW
+	_shadowOn = 0;
+	#endif
+	
+	#ifdef T6963_PAGES
+	_page = 0;
+	_textStart = MEM_TEXT_START;
+	_graphStart = MEM_GRAPH_START;
+	
+	drawPage(1);
+	clearText();
+	clearGraph();
+	drawPage(0);
+	#endif
+	
 	clearText();
 	clearGraph();
 	clearCG();
@@ -65,11 +65,19 @@
 //	Libraries
 //*************************************************************************************************
 
+// build on the host against a software model of the controller
+//#define T6963_EMULATOR
+
 extern "C"{
 	#include <inttypes.h>
+	#include <string.h>
+	#ifdef T6963_EMULATOR
+	#include "utility/T6963_Emulator.h"
+	#else
 	#include <avr/io.h>
 	#include <avr/pgmspace.h>
 	#include <util/delay.h>
+	#endif
 }
 
 #include "T6963_Commands.h"
@@ -79,16 +87,44 @@ extern "C"{
 //	Global Definitions
 //*************************************************************************************************
 
+// panel geometry, select a preset here (T6963.cpp is compiled on its own and never sees a sketch's
+// defines, so both have to take the layout of the class from this file)
+//#define T6963_PANEL_240x64
+//#define T6963_PANEL_128x128
+
+#if defined SCREEN_WIDTH || defined SCREEN_HEIGHT || defined FONT_WIDTH || defined MEM_SIZE
+#error "T6963 geometry is set by a T6963_PANEL_* preset in T6963.h, not before including it"
+#endif
+
+#if defined T6963_PANEL_240x64
+#define SCREEN_WIDTH	240
+#define SCREEN_HEIGHT	64
+#define FONT_WIDTH	6
+#elif defined T6963_PANEL_128x128
+#define SCREEN_WIDTH	128
+#define SCREEN_HEIGHT	128
+#define FONT_WIDTH	8
+#else
 #define SCREEN_WIDTH	240
 #define SCREEN_HEIGHT	128
-
 #define FONT_WIDTH	6
+#endif
+
 #define FONT_HEIGHT	8
 
-#define SCREEN_COLS			(SCREEN_WIDTH/FONT_WIDTH)
+#if FONT_WIDTH < 5 || FONT_WIDTH > 8
+#error "T6963 font width must be 5 to 8 pixels"
+#endif
+
+#if SCREEN_HEIGHT % FONT_HEIGHT
+#error "T6963 screen height must be a multiple of the font height"
+#endif
+
+// a partial column at the right edge still takes a byte in memory
+#define SCREEN_COLS			((SCREEN_WIDTH+FONT_WIDTH-1)/FONT_WIDTH)
 #define SCREEN_ROWS			(SCREEN_HEIGHT/FONT_HEIGHT)
 
-#define MEM_SIZE	8
+#define MEM_SIZE	8			// controller ram (K)
 
 #define MEM_TEXT_START		0
 #define MEM_TEXT_WIDTH		SCREEN_COLS
@@ -97,7 +133,7 @@ extern "C"{
 #define MEM_TEXT_END		(MEM_TEXT_START+MEM_TEXT_AREA)
 
 #define MEM_GRAPH_START		MEM_TEXT_END
-#define MEM_GRAPH_WIDTH		(SCREEN_WIDTH/FONT_WIDTH)
+#define MEM_GRAPH_WIDTH		SCREEN_COLS
 #define MEM_GRAPH_HEIGHT	SCREEN_HEIGHT
 #define MEM_GRAPH_AREA		(MEM_GRAPH_WIDTH*SCREEN_HEIGHT)
 #define MEM_GRAPH_END		(MEM_GRAPH_START+MEM_GRAPH_AREA)
@@ -106,6 +142,75 @@ extern "C"{
 #define MEM_CG_START		(MEM_CG_OFFSET*256*8)
 #define MEM_CG_SIZE			(256*8)
 
+// with the internal rom only codes 0x80-0xFF come from cg ram
+#define MEM_CG_RAM_START	(MEM_CG_START+128*8)
+#define MEM_CG_RAM_SIZE		(128*8)
+
+// scrolling console (two copies of the text area so any row can be the top)
+#define T6963_CONSOLE
+
+#ifdef T6963_CONSOLE
+#define MEM_CONSOLE_START	MEM_GRAPH_END
+#define MEM_CONSOLE_AREA	(MEM_TEXT_AREA*2)
+#define MEM_CONSOLE_END		(MEM_CONSOLE_START+MEM_CONSOLE_AREA)
+
+#if MEM_CONSOLE_END > MEM_CG_RAM_START
+#error "T6963 console does not fit below the character graphics ram"
+#endif
+#endif
+
+// second text and graphic page for page flipping (only when the memory has room)
+#ifdef T6963_CONSOLE
+#define MEM_PAGE_START		MEM_CONSOLE_END
+#else
+#define MEM_PAGE_START		MEM_GRAPH_END
+#endif
+#define MEM_PAGE_TEXT_START		MEM_PAGE_START
+#define MEM_PAGE_GRAPH_START	(MEM_PAGE_TEXT_START+MEM_TEXT_AREA)
+#define MEM_PAGE_END			(MEM_PAGE_GRAPH_START+MEM_GRAPH_AREA)
+
+#if MEM_PAGE_END <= MEM_CG_RAM_START
+#define T6963_PAGES
+#endif
+
+#define T6963_POINTER_UNKNOWN	0xFFFF
+
+// bitmap raster operations
+#define BLIT_COPY	0
+#define BLIT_OR		1
+#define BLIT_XOR	2
+#define BLIT_AND	3
+
+// count bus cycles (status polls, reads, writes and address loads)
+//#define T6963_COUNTERS
+
+// shadow buffer for drawing (a band of graphic rows held in ram)
+//#define T6963_SHADOW
+
+#ifdef T6963_SHADOW
+#define T6963_SHADOW_ROWS	32
+#define T6963_SHADOW_SIZE	(MEM_GRAPH_WIDTH*T6963_SHADOW_ROWS)
+#define T6963_SHADOW_CLEAN	0xFF
+#endif
+
+
+
+//*************************************************************************************************
+//	Global Types
+//*************************************************************************************************
+
+#ifdef T6963_COUNTERS
+typedef struct Counters
+{
+	uint32_t statusReads;
+	uint32_t statusSpins;
+	uint32_t dataReads;
+	uint32_t dataWrites;
+	uint32_t commandWrites;
+	uint32_t addressLoads;
+} COUNTERS;
+#endif
+
 
 
 //*************************************************************************************************
@@ -117,6 +222,12 @@ class T6963
 	public:
 		T6963();
 		
+		#ifdef T6963_COUNTERS
+		Counters counters;
+		
+		void resetCounters(void);
+		#endif
+		
 		void setMode(uint8_t, uint8_t);
 		void setDisplay(uint8_t);
 		
@@ -135,6 +246,14 @@ class T6963
 		
 		void writeBit(uint8_t);
 		void writeBlock(uint8_t, uint16_t);
+		
+		void autoWriteStart(void);
+		void autoWrite(uint8_t);
+		void autoWriteStop(void);
+		
+		void autoReadStart(void);
+		uint8_t autoRead(void);
+		void autoReadStop(void);
 		//void writeBlock(uint8_t, uint8_t, uint8_t);
 		
 		void horizLine(int16_t);
@@ -150,8 +269,17 @@ class T6963
 		void lineTo(uint8_t, uint8_t);
 		void rect(int16_t, int16_t);
 		void rect(int16_t, int16_t, uint8_t);
+		void fillRect(int16_t, int16_t);
 		void rectTo(uint8_t, uint8_t);
 		
+		void blit(int16_t, int16_t, prog_uchar*, uint8_t, uint8_t, uint8_t);
+		
+		#ifdef T6963_SHADOW
+		void shadowBegin(uint8_t);
+		void shadowEnd(void);
+		void flush(void);
+		#endif
+		
 		void clearText(void);
 		void clearText(int16_t);
 		void text(int16_t, int16_t);
@@ -161,11 +289,22 @@ class T6963
 		void textPgm(prog_char*);
 		void textPgm(prog_char*, int16_t);
 		
+		#ifdef T6963_CONSOLE
+		void consoleBegin(void);
+		void consoleEnd(void);
+		void consoleLine(char*);
+		void consoleLinePgm(prog_char*);
+		#endif
+		
+		void beginFrame(void);
+		void endFrame(void);
+		
 		void clearCG(void);
 		
 		void init(void);
 		
 	private:
+		uint16_t _pointer;
 		uint16_t _address;
 		uint16_t _text;
 		
@@ -175,6 +314,41 @@ class T6963
 		uint8_t _lastX;
 		uint8_t _lastY;
 		
+		#ifdef T6963_SHADOW
+		uint8_t _shadow[T6963_SHADOW_SIZE];
+		uint8_t _dirtyLeft[T6963_SHADOW_ROWS];
+		uint8_t _dirtyRight[T6963_SHADOW_ROWS];
+		uint16_t _shadowStart;
+		uint8_t _shadowOn;
+		
+		uint8_t shadowed(void);
+		void markDirty(uint16_t, uint16_t);
+		#endif
+		
+		#ifdef T6963_PAGES
+		uint16_t _textStart;
+		uint16_t _graphStart;
+		uint8_t _page;
+		
+		void drawPage(uint8_t);
+		#endif
+		
+		#ifdef T6963_CONSOLE
+		uint8_t _consoleTop;
+		uint8_t _consoleRows;
+		
+		uint8_t consoleRow(void);
+		void consoleWrite(uint8_t, char*, uint8_t);
+		#endif
+		
+		uint8_t bitmapBits(prog_uchar*, uint8_t, int16_t);
+		
+		void plot(uint8_t);
+		void edge(uint8_t);
+		void fill(uint8_t, int16_t);
+		
+		void loadPointer(uint16_t);
+		
 		uint8_t readStatus(void);
 		uint8_t readData(void);
 		
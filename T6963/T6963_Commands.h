@@ -41,6 +41,11 @@
 #define T6963_BIT_RESET  0x00
 #define T6963_BIT_SET    0x08
 
+#define T6963_STATUS_CMD		0x01
+#define T6963_STATUS_DATA		0x02
+#define T6963_STATUS_AUTO_READ		0x04
+#define T6963_STATUS_AUTO_WRITE		0x08
+
 
 
 
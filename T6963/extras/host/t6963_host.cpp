@@ -0,0 +1,690 @@
+/*
+	Host checks for the T6963 library by Ian T Metcalf
+		builds T6963.cpp against the controller model in utility/T6963_Emulator.c
+	
+	Each check draws through the library, compares the controller memory with a pixel
+	model and prints the bus cycles (status reads, data and command transfers) per call.
+	Run with "make check" in this folder, it fails if a check does.
+	
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+	
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+
+//*************************************************************************************************
+//	Libraries
+//*************************************************************************************************
+
+#include <T6963.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+
+//*************************************************************************************************
+//	Global Variables
+//*************************************************************************************************
+
+static uint8_t model[SCREEN_HEIGHT][SCREEN_WIDTH];
+static uint8_t failed;
+
+
+
+
+//*************************************************************************************************
+//	Helper Functions
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Get a pixel of a graphic page from controller memory
+//
+//	Input	graph: page graphic start address
+//			x, y: pixel
+//
+//	Output	pixel color
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint8_t pixel(uint16_t graph, int16_t x, int16_t y)
+{
+	uint16_t address = graph + y * MEM_GRAPH_WIDTH + x / FONT_WIDTH;
+	
+	return (t6963_emu.mem[address] >> (FONT_WIDTH - 1 - x % FONT_WIDTH)) & 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Load the pixel model from a graphic page
+//
+//	Input	graph: page graphic start address
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void loadModel(uint16_t graph)
+{
+	int16_t x, y;
+	
+	for (y = 0; y < SCREEN_HEIGHT; y++)
+	{
+		for (x = 0; x < SCREEN_WIDTH; x++)
+		{
+			model[y][x] = pixel(graph, x, y);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Count the pixels of a graphic page that differ from the model
+//
+//	Input	graph: page graphic start address
+//
+//	Output	number of wrong pixels
+//
+//-------------------------------------------------------------------------------------------------
+
+static uint32_t checkModel(uint16_t graph)
+{
+	uint32_t wrong = 0;
+	int16_t x, y;
+	
+	for (y = 0; y < SCREEN_HEIGHT; y++)
+	{
+		for (x = 0; x < SCREEN_WIDTH; x++)
+		{
+			if (model[y][x] != pixel(graph, x, y))
+			{
+				wrong++;
+			}
+		}
+	}
+	
+	return wrong;
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Set a box of the pixel model
+//
+//	Input	x0, y0, x1, y1: corners (inclusive, any order)
+//			color: pixel color
+//			outline: only the edges
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void modelBox(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color, uint8_t outline)
+{
+	int16_t x, y, tmp;
+	
+	if (x0 > x1)
+	{
+		tmp = x0; x0 = x1; x1 = tmp;
+	}
+	
+	if (y0 > y1)
+	{
+		tmp = y0; y0 = y1; y1 = tmp;
+	}
+	
+	for (y = y0; y <= y1; y++)
+	{
+		for (x = x0; x <= x1; x++)
+		{
+			if (!outline || x == x0 || x == x1 || y == y0 || y == y1)
+			{
+				model[y][x] = color;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Set a line of the pixel model, drawn up to (not on) its end point
+//		(each step along the longer axis rounds the other half up, as the run slices do)
+//
+//	Input	x, y: start
+//			dx, dy: change to the end point
+//			color: pixel color
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void modelLine(int16_t x, int16_t y, int16_t dx, int16_t dy, uint8_t color)
+{
+	int16_t adx, ady, steps, i, minor;
+	
+	adx = (dx < 0) ? -dx : dx;
+	ady = (dy < 0) ? -dy : dy;
+	steps = (adx > ady) ? adx : ady;
+	
+	for (i = 0; i < steps; i++)
+	{
+		if (adx >= ady)
+		{
+			minor = (2 * i * ady + steps) / (2 * steps);
+			model[y + ((dy < 0) ? -minor : minor)][x + ((dx < 0) ? -i : i)] = color;
+		}
+		else
+		{
+			minor = (2 * i * adx + steps) / (2 * steps);
+			model[y + ((dy < 0) ? -i : i)][x + ((dx < 0) ? -minor : minor)] = color;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Print the result of a check
+//
+//	Input	*name: check name
+//			calls: api calls made
+//			cycles: bus cycles of the calls
+//			wrong: wrong pixels or bytes (0 passes)
+//
+//	Output	none
+//
+//-------------------------------------------------------------------------------------------------
+
+static void report(const char *name, uint32_t calls, uint32_t cycles, uint32_t wrong)
+{
+	if (wrong || t6963_emu.count.errors)
+	{
+		failed++;
+	}
+	
+	printf("%-10s %6u calls %9.1f cycles/call  %s", name, calls, (calls) ? (double)cycles / calls : 0.0, (wrong || t6963_emu.count.errors) ? "FAIL" : "ok");
+	
+	if (wrong || t6963_emu.count.errors)
+	{
+		printf(" (%u wrong, %u bus errors)", wrong, t6963_emu.count.errors);
+	}
+	
+	printf("\n");
+	
+	t6963_emu.count.errors = 0;
+}
+
+
+
+
+//*************************************************************************************************
+//	Checks
+//*************************************************************************************************
+
+//-------------------------------------------------------------------------------------------------
+//
+// Controller set up and clearing
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkInit(void)
+{
+	uint32_t wrong = 0;
+	uint16_t address;
+	
+	t6963_emu_clear_counters();
+	LCD.init();
+	report("init", 1, t6963_emu_cycles(), 0);
+	
+	memset(t6963_emu.mem + MEM_TEXT_START, 0x55, MEM_TEXT_AREA);
+	memset(t6963_emu.mem + MEM_GRAPH_START, 0x55, MEM_GRAPH_AREA);
+	
+	t6963_emu_clear_counters();
+	LCD.clearText();
+	LCD.clearGraph();
+	
+	for (address = MEM_TEXT_START; address < MEM_GRAPH_END; address++)
+	{
+		if (t6963_emu.mem[address])
+		{
+			wrong++;
+		}
+	}
+	
+	report("clear", 2, t6963_emu_cycles(), wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Outlined and filled rectangles at random places, in both colors
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkRect(uint8_t fill)
+{
+	uint32_t calls = 0, cycles = 0, wrong = 0;
+	uint16_t count;
+	int16_t x, y, dx, dy;
+	uint8_t color;
+	
+	srand(1);
+	LCD.clearGraph();
+	loadModel(MEM_GRAPH_START);
+	
+	for (count = 0; count < 300; count++)
+	{
+		x = rand() % SCREEN_WIDTH;
+		y = rand() % SCREEN_HEIGHT;
+		dx = rand() % 61 - 30;
+		dy = rand() % 41 - 20;
+		color = (count % 4) ? 1 : 0;
+		
+		// a flat rect is a line, drawn up to (not on) its end point
+		if (dx == 0 || dy == 0 || x + dx < 0 || x + dx >= SCREEN_WIDTH || y + dy < 0 || y + dy >= SCREEN_HEIGHT)
+		{
+			continue;
+		}
+		
+		LCD.setColor(color);
+		LCD.moveTo(x, y);
+		
+		t6963_emu_clear_counters();
+		
+		if (fill)
+		{
+			LCD.fillRect(dx, dy);
+		}
+		else
+		{
+			LCD.rect(dx, dy);
+		}
+		
+		cycles += t6963_emu_cycles();
+		calls++;
+		
+		modelBox(x, y, x + dx, y + dy, color, !fill);
+		wrong += checkModel(MEM_GRAPH_START);
+	}
+	
+	LCD.setColor(1);
+	report((fill) ? "fillRect" : "rect", calls, cycles, wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Relative lines, first along each axis and diagonal across byte boundaries, then at random
+//		(shallow and steep bresenham slopes both ways)
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkLine(void)
+{
+	static const int16_t fixed[][4] =
+	{
+		{ FONT_WIDTH - 2, 10, 3 * FONT_WIDTH + 1, 0 },		// horizontal, both ways
+		{ 5 * FONT_WIDTH + 1, 12, -4 * FONT_WIDTH, 0 },
+		{ FONT_WIDTH - 1, 20, 0, 30 },						// vertical, both ways
+		{ FONT_WIDTH, 60, 0, -25 },
+		{ FONT_WIDTH - 3, 30, 20, 20 },						// diagonal, each quadrant
+		{ 4 * FONT_WIDTH + 2, 30, -20, 20 },
+		{ FONT_WIDTH - 3, 60, 20, -20 },
+		{ 4 * FONT_WIDTH + 2, 60, -20, -20 },
+		{ FONT_WIDTH - 1, 40, 37, 5 },						// shallow, each quadrant
+		{ 7 * FONT_WIDTH, 40, -37, 5 },
+		{ FONT_WIDTH - 1, 40, 37, -5 },
+		{ 7 * FONT_WIDTH, 40, -37, -5 },
+		{ FONT_WIDTH - 1, 5, 5, 37 },						// steep, each quadrant
+		{ FONT_WIDTH + 1, 5, -5, 37 },
+		{ FONT_WIDTH - 1, 50, 5, -37 },
+		{ FONT_WIDTH + 1, 50, -5, -37 },
+		{ 2, 10, 16, 2 },									// even run lengths
+		{ 2, 10, 2, 16 },
+	};
+	uint32_t calls = 0, cycles = 0, wrong = 0;
+	uint16_t count, total;
+	int16_t x, y, dx, dy;
+	uint8_t color;
+	
+	srand(4);
+	LCD.clearGraph();
+	loadModel(MEM_GRAPH_START);
+	
+	total = sizeof(fixed) / sizeof(fixed[0]);
+	
+	for (count = 0; count < total + 300; count++)
+	{
+		if (count < total)
+		{
+			x = fixed[count][0];
+			y = fixed[count][1];
+			dx = fixed[count][2];
+			dy = fixed[count][3];
+			color = 1;
+		}
+		else
+		{
+			x = rand() % SCREEN_WIDTH;
+			y = rand() % SCREEN_HEIGHT;
+			dx = rand() % 81 - 40;
+			dy = rand() % 81 - 40;
+			color = (count % 4) ? 1 : 0;
+		}
+		
+		if (x + dx < 0 || x + dx >= SCREEN_WIDTH || y + dy < 0 || y + dy >= SCREEN_HEIGHT)
+		{
+			continue;
+		}
+		
+		LCD.setColor(color);
+		LCD.moveTo(x, y);
+		
+		t6963_emu_clear_counters();
+		LCD.line(dx, dy);
+		cycles += t6963_emu_cycles();
+		calls++;
+		
+		modelLine(x, y, dx, dy, color);
+		wrong += checkModel(MEM_GRAPH_START);
+	}
+	
+	LCD.setColor(1);
+	report("line", calls, cycles, wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Polylines of absolute lines, each starting where the last one ended
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkLineTo(void)
+{
+	uint32_t calls = 0, cycles = 0, wrong = 0;
+	uint16_t count;
+	int16_t x, y, lastX, lastY;
+	
+	srand(5);
+	LCD.clearGraph();
+	loadModel(MEM_GRAPH_START);
+	
+	lastX = 0;
+	lastY = 0;
+	
+	LCD.setColor(1);
+	LCD.moveTo(lastX, lastY);
+	
+	for (count = 0; count < 300; count++)
+	{
+		x = rand() % SCREEN_WIDTH;
+		y = rand() % SCREEN_HEIGHT;
+		
+		// three points in eight are along an axis or a diagonal of the last one
+		switch (count % 8)
+		{
+			case 1:	y = lastY;	break;
+			case 3:	x = lastX;	break;
+			case 5:
+				y = lastY + ((x > lastX) ? x - lastX : lastX - x);
+				
+				if (y >= SCREEN_HEIGHT)
+				{
+					y = lastY - ((x > lastX) ? x - lastX : lastX - x);
+				}
+				break;
+		}
+		
+		if (y < 0 || y >= SCREEN_HEIGHT)
+		{
+			continue;
+		}
+		
+		t6963_emu_clear_counters();
+		LCD.lineTo(x, y);
+		cycles += t6963_emu_cycles();
+		calls++;
+		
+		modelLine(lastX, lastY, x - lastX, y - lastY, 1);
+		wrong += checkModel(MEM_GRAPH_START);
+		
+		lastX = x;
+		lastY = y;
+	}
+	
+	report("lineTo", calls, cycles, wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Program memory bitmaps with each raster op, clipped at the screen edges
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkBlit(void)
+{
+	static uint8_t bitmap[8 * 40];
+	uint32_t cycles = 0, wrong = 0;
+	uint16_t count, i;
+	int16_t x, y, w, h, row, col, px, py;
+	uint8_t op, bit, bytes;
+	
+	srand(3);
+	LCD.clearGraph();
+	loadModel(MEM_GRAPH_START);
+	
+	for (count = 0; count < 300; count++)
+	{
+		w = rand() % 60 + 1;
+		h = rand() % 30 + 1;
+		x = rand() % (SCREEN_WIDTH + 80) - 60;
+		y = rand() % (SCREEN_HEIGHT + 40) - 30;
+		op = rand() % 4;
+		bytes = (w + 7) / 8;
+		
+		for (i = 0; i < bytes * h; i++)
+		{
+			bitmap[i] = rand();
+		}
+		
+		t6963_emu_clear_counters();
+		LCD.blit(x, y, bitmap, w, h, op);
+		
+		#ifdef T6963_SHADOW
+		LCD.flush();
+		#endif
+		
+		cycles += t6963_emu_cycles();
+		
+		for (row = 0; row < h; row++)
+		{
+			for (col = 0; col < w; col++)
+			{
+				px = x + col;
+				py = y + row;
+				
+				if (px < 0 || py < 0 || px >= SCREEN_WIDTH || py >= SCREEN_HEIGHT)
+				{
+					continue;
+				}
+				
+				bit = (bitmap[row * bytes + col / 8] >> (7 - col % 8)) & 1;
+				
+				switch (op)
+				{
+					case BLIT_COPY:	model[py][px] = bit;	break;
+					case BLIT_OR:	model[py][px] |= bit;	break;
+					case BLIT_XOR:	model[py][px] ^= bit;	break;
+					case BLIT_AND:	model[py][px] &= bit;	break;
+				}
+			}
+		}
+		
+		wrong += checkModel(MEM_GRAPH_START);
+	}
+	
+	report("blit", count, cycles, wrong);
+}
+
+//-------------------------------------------------------------------------------------------------
+//
+// Text written across each row of the text area
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkText(void)
+{
+	char line[] = "The quick brown fox jumps over the lazy dog 0123456789";
+	uint32_t cycles = 0, wrong = 0;
+	uint8_t row, col, size;
+	
+	LCD.clearText();
+	
+	size = (strlen(line) < MEM_TEXT_WIDTH) ? strlen(line) : MEM_TEXT_WIDTH;
+	
+	for (row = 0; row < MEM_TEXT_HEIGHT; row++)
+	{
+		t6963_emu_clear_counters();
+		LCD.textTo(0, row);
+		LCD.text(line, size);
+		cycles += t6963_emu_cycles();
+		
+		for (col = 0; col < size; col++)
+		{
+			if (t6963_emu.mem[MEM_TEXT_START + row * MEM_TEXT_WIDTH + col] != line[col] - 32)
+			{
+				wrong++;
+			}
+		}
+	}
+	
+	report("text", MEM_TEXT_HEIGHT, cycles, wrong);
+}
+
+#ifdef T6963_CONSOLE
+//-------------------------------------------------------------------------------------------------
+//
+// Console lines scrolled past the bottom, then the text area shown again
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkConsole(void)
+{
+	char line[16];
+	uint32_t cycles = 0, wrong = 0;
+	uint16_t home;
+	uint8_t count, row;
+	
+	LCD.consoleBegin();
+	
+	for (count = 0; count < 3 * MEM_TEXT_HEIGHT; count++)
+	{
+		sprintf(line, "LINE %u", count);
+		
+		t6963_emu_clear_counters();
+		LCD.consoleLine(line);
+		cycles += t6963_emu_cycles();
+	}
+	
+	// the screen shows the last full screen of lines, oldest at the top
+	for (row = 0; row < MEM_TEXT_HEIGHT; row++)
+	{
+		sprintf(line, "LINE %u", count - MEM_TEXT_HEIGHT + row);
+		home = t6963_emu.textHome + row * MEM_TEXT_WIDTH;
+		
+		for (count = 0; line[count]; count++)
+		{
+			if (t6963_emu.mem[home + count] != line[count] - 32)
+			{
+				wrong++;
+			}
+		}
+		
+		count = 3 * MEM_TEXT_HEIGHT;
+	}
+	
+	LCD.consoleEnd();
+	
+	if (t6963_emu.textHome != MEM_TEXT_START)
+	{
+		wrong++;
+	}
+	
+	report("console", 3 * MEM_TEXT_HEIGHT, cycles, wrong);
+}
+#endif
+
+#ifdef T6963_PAGES
+//-------------------------------------------------------------------------------------------------
+//
+// Frames drawn on the hidden page and flipped (through the shadow band when it is built in)
+//
+//-------------------------------------------------------------------------------------------------
+
+static void checkFrames(void)
+{
+	uint32_t cycles = 0, wrong = 0;
+	uint8_t count;
+	
+	LCD.clearGraph();
+	
+	#ifdef T6963_SHADOW
+	LCD.shadowBegin(0);
+	#endif
+	
+	for (count = 0; count < 8; count++)
+	{
+		LCD.beginFrame();
+		LCD.clearGraph();
+		
+		memset(model, 0, sizeof(model));
+		
+		LCD.setColor(1);
+		LCD.moveTo(count * 4, count * 2);
+		LCD.fillRect(20, 10);
+		modelBox(count * 4, count * 2, count * 4 + 20, count * 2 + 10, 1, 0);
+		
+		t6963_emu_clear_counters();
+		LCD.endFrame();
+		cycles += t6963_emu_cycles();
+		
+		wrong += checkModel(t6963_emu.graphHome);
+	}
+	
+	#ifdef T6963_SHADOW
+	LCD.shadowEnd();
+	#endif
+	
+	report("endFrame", count, cycles, wrong);
+}
+#endif
+
+
+
+
+//*************************************************************************************************
+//	Main
+//*************************************************************************************************
+
+int main(void)
+{
+	printf("T6963 %ux%u, font %u, %uK\n", SCREEN_WIDTH, SCREEN_HEIGHT, FONT_WIDTH, MEM_SIZE);
+	
+	checkInit();
+	checkLine();
+	checkLineTo();
+	checkRect(0);
+	checkRect(1);
+	checkBlit();
+	checkText();
+	
+	#ifdef T6963_CONSOLE
+	checkConsole();
+	#endif
+	
+	#ifdef T6963_PAGES
+	checkFrames();
+	#endif
+	
+	return (failed) ? 1 : 0;
+}
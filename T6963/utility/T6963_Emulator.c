@@ -0,0 +1,374 @@
+/*
+	Software model of the T6963 LCD controller by Ian T Metcalf
+		used to build and run the T6963 library on a host machine
+
+	See T6963_Emulator.h for what is modeled.
+
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+#ifdef T6963_EMULATOR
+
+/****************************************************************************
+  Libraries
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "T6963_Emulator.h"
+#include "../T6963_Commands.h"
+
+/****************************************************************************
+  Global variable
+****************************************************************************/
+
+T6963_Emulator t6963_emu;
+
+// Internal character rom (5x7 ascii, codes 0x00 - 0x5F = ' ' - 0x7F), one byte per column
+static const uint8_t romFont[96][5] =
+{
+	{0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+	{0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+	{0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+	{0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+	{0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+	{0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+	{0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+	{0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06},
+	{0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+	{0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A},
+	{0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+	{0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+	{0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+	{0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+	{0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+	{0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+	{0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20},
+	{0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+	{0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+	{0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+	{0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+	{0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+	{0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+	{0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08}, {0x00, 0x00, 0x00, 0x00, 0x00}
+};
+
+/****************************************************************************
+  Controller interface
+****************************************************************************/
+
+// Power up the model with a font width (6 or 8) and display ram size in kbytes
+void t6963_emu_init(uint8_t fontWidth, uint8_t memSize)
+{
+	memset(&t6963_emu, 0, sizeof(t6963_emu));
+
+	t6963_emu.fontWidth = fontWidth;
+	t6963_emu.memMask = (uint16_t)(((uint32_t)memSize << 10) - 1);
+}
+
+// Status read: command/data ready, or only the auto bit while in an auto mode
+uint8_t t6963_emu_status(void)
+{
+	t6963_emu.count.statusReads++;
+
+	switch (t6963_emu.autoMode)
+	{
+		case T6963_EMU_AUTO_WRITE:
+			return T6963_STATUS_AUTO_WRITE;
+
+		case T6963_EMU_AUTO_READ:
+			return T6963_STATUS_AUTO_READ;
+	}
+
+	return T6963_STATUS_CMD | T6963_STATUS_DATA;
+}
+
+// Data read: the latched byte, or the next byte in auto read mode
+uint8_t t6963_emu_read(void)
+{
+	t6963_emu.count.dataReads++;
+
+	if (t6963_emu.autoMode == T6963_EMU_AUTO_READ)
+	{
+		uint8_t tmp = t6963_emu.mem[t6963_emu.address & t6963_emu.memMask];
+		t6963_emu.address++;
+		return tmp;
+	}
+
+	if (t6963_emu.autoMode == T6963_EMU_AUTO_WRITE)
+	{
+		t6963_emu.count.errors++;
+	}
+
+	return t6963_emu.latch;
+}
+
+// Data write: a command argument, or the next byte in auto write mode
+void t6963_emu_data(uint8_t data)
+{
+	t6963_emu.count.dataWrites++;
+
+	if (t6963_emu.autoMode == T6963_EMU_AUTO_WRITE)
+	{
+		t6963_emu.mem[t6963_emu.address & t6963_emu.memMask] = data;
+		t6963_emu.address++;
+		return;
+	}
+
+	if (t6963_emu.autoMode == T6963_EMU_AUTO_READ || t6963_emu.argCount >= 2)
+	{
+		t6963_emu.count.errors++;
+		return;
+	}
+
+	t6963_emu.args[t6963_emu.argCount++] = data;
+}
+
+// Command write: execute with the arguments written before it
+void t6963_emu_command(uint8_t command)
+{
+	uint16_t word = t6963_emu.args[0] | ((uint16_t)t6963_emu.args[1] << 8);
+	uint16_t addr = t6963_emu.address & t6963_emu.memMask;
+
+	t6963_emu.count.commandWrites++;
+
+	if (t6963_emu.autoMode != T6963_EMU_AUTO_OFF && command != T6963_AUTO_RESET)
+	{
+		t6963_emu.count.errors++;
+		return;
+	}
+
+	switch (command & 0xF0)
+	{
+		case 0x20:
+			if (command == T6963_SET_CURSOR_POINTER)
+			{
+				t6963_emu.cursorCol = t6963_emu.args[0];
+				t6963_emu.cursorRow = t6963_emu.args[1];
+			}
+			else if (command == T6963_SET_OFFSET_REGISTER)
+			{
+				t6963_emu.offset = t6963_emu.args[0] & 0x1F;
+			}
+			else if (command == T6963_SET_ADDRESS_POINTER)
+			{
+				t6963_emu.address = word;
+			}
+			else
+			{
+				t6963_emu.count.errors++;
+			}
+			break;
+
+		case 0x40:
+			switch (command)
+			{
+				case T6963_SET_TEXT_HOME_ADDRESS:		t6963_emu.textHome = word;		break;
+				case T6963_SET_TEXT_AREA:				t6963_emu.textArea = word;		break;
+				case T6963_SET_GRAPHIC_HOME_ADDRESS:	t6963_emu.graphHome = word;		break;
+				case T6963_SET_GRAPHIC_AREA:			t6963_emu.graphArea = word;		break;
+				default:								t6963_emu.count.errors++;		break;
+			}
+			break;
+
+		case T6963_MODE_SET:
+			t6963_emu.mode = command & 0x0F;
+			break;
+
+		case T6963_DISPLAY_MODE:
+			t6963_emu.display = command & 0x0F;
+			break;
+
+		case T6963_CURSOR_PATTERN_SELECT:
+			t6963_emu.cursorPattern = command & 0x07;
+			break;
+
+		case 0xB0:
+			if (command == T6963_SET_DATA_AUTO_WRITE)
+			{
+				t6963_emu.autoMode = T6963_EMU_AUTO_WRITE;
+			}
+			else if (command == T6963_SET_DATA_AUTO_READ)
+			{
+				t6963_emu.autoMode = T6963_EMU_AUTO_READ;
+			}
+			else if (command == T6963_AUTO_RESET)
+			{
+				t6963_emu.autoMode = T6963_EMU_AUTO_OFF;
+			}
+			else
+			{
+				t6963_emu.count.errors++;
+			}
+			break;
+
+		case 0xC0:
+			switch (command)
+			{
+				case T6963_DATA_WRITE_AND_INCREMENT:
+				case T6963_DATA_WRITE_AND_DECREMENT:
+				case T6963_DATA_WRITE_AND_NONVARIABLE:
+					t6963_emu.mem[addr] = t6963_emu.args[0];
+					break;
+
+				case T6963_DATA_READ_AND_INCREMENT:
+				case T6963_DATA_READ_AND_DECREMENT:
+				case T6963_DATA_READ_AND_NONVARIABLE:
+					t6963_emu.latch = t6963_emu.mem[addr];
+					break;
+
+				default:
+					t6963_emu.count.errors++;
+					break;
+			}
+
+			if (command == T6963_DATA_WRITE_AND_INCREMENT || command == T6963_DATA_READ_AND_INCREMENT)
+			{
+				t6963_emu.address++;
+			}
+			else if (command == T6963_DATA_WRITE_AND_DECREMENT || command == T6963_DATA_READ_AND_DECREMENT)
+			{
+				t6963_emu.address--;
+			}
+			break;
+
+		case T6963_SCREEN_PEEK:
+			t6963_emu.latch = t6963_emu.mem[addr];
+			break;
+
+		case T6963_SET_PIXEL:
+			if (command & T6963_BIT_SET)
+			{
+				t6963_emu.mem[addr] |= (1 << (command & 0x07));
+			}
+			else
+			{
+				t6963_emu.mem[addr] &= ~(1 << (command & 0x07));
+			}
+			break;
+
+		default:
+			t6963_emu.count.errors++;
+			break;
+	}
+
+	t6963_emu.argCount = 0;
+	t6963_emu.args[0] = 0;
+	t6963_emu.args[1] = 0;
+}
+
+/****************************************************************************
+  Measurement
+****************************************************************************/
+
+// Total bus cycles since the counters were cleared
+uint32_t t6963_emu_cycles(void)
+{
+	return t6963_emu.count.statusReads + t6963_emu.count.dataReads + t6963_emu.count.dataWrites + t6963_emu.count.commandWrites;
+}
+
+void t6963_emu_clear_counters(void)
+{
+	memset(&t6963_emu.count, 0, sizeof(t6963_emu.count));
+}
+
+/****************************************************************************
+  Display output
+****************************************************************************/
+
+// Composited pixel on the screen (1 = dark)
+uint8_t t6963_emu_pixel(uint16_t x, uint16_t y)
+{
+	uint8_t fw = t6963_emu.fontWidth;
+	uint8_t col = x / fw;
+	uint8_t bit = fw - 1 - (x % fw);
+	uint8_t graph = 0;
+	uint8_t text = 0;
+
+	if (t6963_emu.display & (1 << T6963_DISPLAY_GRAPHIC))
+	{
+		uint16_t addr = t6963_emu.graphHome + y * t6963_emu.graphArea + col;
+		graph = (t6963_emu.mem[addr & t6963_emu.memMask] >> bit) & 0x01;
+	}
+
+	if (t6963_emu.display & (1 << T6963_DISPLAY_TEXT))
+	{
+		uint16_t addr = t6963_emu.textHome + (y / 8) * t6963_emu.textArea + col;
+		uint8_t code = t6963_emu.mem[addr & t6963_emu.memMask];
+		uint8_t row = y % 8;
+
+		if (code < 0x80 && !(t6963_emu.mode & T6963_MODE_EXTERNAL))
+		{
+			uint8_t glyph = x % fw;
+
+			if (code < 96 && glyph < 5)
+			{
+				text = (romFont[code][glyph] >> row) & 0x01;
+			}
+		}
+		else
+		{
+			uint16_t cg = ((uint16_t)t6963_emu.offset << 11) + code * 8 + row;
+			text = (t6963_emu.mem[cg & t6963_emu.memMask] >> bit) & 0x01;
+		}
+
+		if ((t6963_emu.display & (1 << T6963_DISPLAY_CURSOR)) && col == t6963_emu.cursorCol && (y / 8) == t6963_emu.cursorRow && row >= 7 - t6963_emu.cursorPattern)
+		{
+			text = 1;
+		}
+	}
+
+	// attribute mode uses the graphic area for attributes, only the text is shown
+	switch (t6963_emu.mode & 0x07)
+	{
+		case T6963_MODE_XOR:	return text ^ graph;
+		case T6963_MODE_AND:	return text & graph;
+		case T6963_MODE_TEXT:	return text;
+	}
+
+	return text | graph;
+}
+
+// Write the screen as a binary PBM image, returns 0 on success
+int t6963_emu_save_pbm(const char *path, uint16_t width, uint16_t height)
+{
+	FILE *file;
+	uint16_t x, y;
+
+	file = fopen(path, "wb");
+
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	fprintf(file, "P4\n%u %u\n", width, height);
+
+	for (y = 0; y < height; y++)
+	{
+		uint8_t data = 0;
+
+		for (x = 0; x < width; x++)
+		{
+			data = (data << 1) | t6963_emu_pixel(x, y);
+
+			if ((x & 0x07) == 0x07)
+			{
+				fputc(data, file);
+				data = 0;
+			}
+		}
+
+		if (width & 0x07)
+		{
+			fputc(data << (8 - (width & 0x07)), file);
+		}
+	}
+
+	return fclose(file);
+}
+
+#endif // T6963_EMULATOR
@@ -0,0 +1,125 @@
+/*
+	Software model of the T6963 LCD controller by Ian T Metcalf
+		used to build and run the T6963 library on a host machine
+
+	Define T6963_EMULATOR when compiling T6963.cpp (and this file) on the host
+	and the GLCD port macros talk to this model instead of the avr ports.
+
+	Modeled:
+		address pointer, text/graphic home and area registers
+		mode set (OR, XOR, AND, text attribute) and display mode
+		offset register and CG ram (internal rom font for codes below 0x80)
+		single byte and auto read/write data transfers, set/reset pixel
+		cursor pointer and pattern
+
+	Bus accesses are counted so the cost of an api call can be measured, and
+	the composited screen can be written out as a PBM image.
+
+	extras/host builds the library against this model and runs drawing checks
+	that print the bus cycles per call (make check).
+
+	All works by ITM are released under the creative commons attribution share alike license
+		http://creativecommons.org/licenses/by-sa/3.0/
+
+	I can be contacted at metcalfbuilt@gmail.com
+*/
+
+#ifndef T6963_EMULATOR_H
+#define T6963_EMULATOR_H
+
+#ifdef T6963_EMULATOR
+
+#include <inttypes.h>
+
+/****************************************************************************
+  Host replacements for the avr headers used by the library
+****************************************************************************/
+
+#ifndef F_CPU
+#define F_CPU	16000000UL
+#endif
+
+#ifndef PROGMEM
+#define PROGMEM
+typedef char prog_char;
+typedef unsigned char prog_uchar;
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#endif
+
+#define _delay_us(us)
+#define _delay_ms(ms)
+
+/****************************************************************************
+  Controller model
+****************************************************************************/
+
+#define T6963_EMU_MEM_MAX		0x10000
+
+#define T6963_EMU_AUTO_OFF		0
+#define T6963_EMU_AUTO_WRITE	1
+#define T6963_EMU_AUTO_READ		2
+
+typedef struct
+{
+	uint32_t statusReads;
+	uint32_t dataReads;
+	uint32_t dataWrites;
+	uint32_t commandWrites;
+	uint32_t errors;
+}
+T6963_Counters;
+
+typedef struct
+{
+	uint8_t mem[T6963_EMU_MEM_MAX];
+	uint16_t memMask;
+	uint8_t fontWidth;
+
+	uint16_t address;
+	uint16_t textHome;
+	uint16_t textArea;
+	uint16_t graphHome;
+	uint16_t graphArea;
+	uint8_t offset;
+	uint8_t mode;
+	uint8_t display;
+
+	uint8_t cursorCol;
+	uint8_t cursorRow;
+	uint8_t cursorPattern;
+
+	uint8_t args[2];
+	uint8_t argCount;
+	uint8_t autoMode;
+	uint8_t latch;
+
+	// value on the data bus and the (unused) control port direction
+	uint8_t bus;
+	uint8_t ddr;
+
+	T6963_Counters count;
+}
+T6963_Emulator;
+
+extern T6963_Emulator t6963_emu;
+
+/****************************************************************************
+  Function definitions
+****************************************************************************/
+
+extern void t6963_emu_init(uint8_t fontWidth, uint8_t memSize);
+
+extern uint8_t t6963_emu_status(void);
+extern uint8_t t6963_emu_read(void);
+extern void t6963_emu_data(uint8_t data);
+extern void t6963_emu_command(uint8_t command);
+
+extern uint32_t t6963_emu_cycles(void);
+extern void t6963_emu_clear_counters(void);
+
+extern uint8_t t6963_emu_pixel(uint16_t x, uint16_t y);
+extern int t6963_emu_save_pbm(const char *path, uint16_t width, uint16_t height);
+
+#endif // T6963_EMULATOR
+
+#endif // T6963_EMULATOR_H